@@ -15,11 +15,19 @@ static inline void local_flush_icache_all(void)
 
 #define flush_icache_range(start, end) local_flush_icache_all()
 #define flush_icache_user_range(vma, pg, addr, len) local_flush_icache_all()
+#define flush_icache_mm(mm) local_flush_icache_all()
 
 #else /* CONFIG_SMP */
 
+#include <asm/sbi.h>
+
+struct mm_struct;
+
+void flush_icache_mm(struct mm_struct *mm);
+
 #define flush_icache_range(start, end) sbi_remote_fence_i(0)
-#define flush_icache_user_range(vma, pg, addr, len) sbi_remote_fence_i(0)
+#define flush_icache_user_range(vma, pg, addr, len) \
+	flush_icache_mm((vma)->vm_mm)
 
 #endif /* CONFIG_SMP */
 
@@ -0,0 +1,8 @@
+#ifndef _ASM_RISCV_CLOCKSOURCE_H
+#define _ASM_RISCV_CLOCKSOURCE_H
+
+struct arch_clocksource_data {
+	int vdso_direct;	/* Usable for direct vDSO access? */
+};
+
+#endif /* _ASM_RISCV_CLOCKSOURCE_H */
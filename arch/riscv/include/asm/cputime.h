@@ -0,0 +1,11 @@
+#ifndef _ASM_RISCV_CPUTIME_H
+#define _ASM_RISCV_CPUTIME_H
+
+#ifdef CONFIG_VIRT_CPU_ACCOUNTING_NATIVE
+#include <asm-generic/cputime_nsecs.h>
+extern void arch_vtime_task_switch(struct task_struct *tsk);
+#else
+#include <asm-generic/cputime.h>
+#endif /* CONFIG_VIRT_CPU_ACCOUNTING_NATIVE */
+
+#endif /* _ASM_RISCV_CPUTIME_H */
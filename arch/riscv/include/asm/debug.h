@@ -0,0 +1,9 @@
+#ifndef _ASM_RISCV_DEBUG_H
+#define _ASM_RISCV_DEBUG_H
+
+struct dentry;
+
+/* Parent directory of the architecture statistics in debugfs */
+extern struct dentry *riscv_debugfs_root;
+
+#endif /* _ASM_RISCV_DEBUG_H */
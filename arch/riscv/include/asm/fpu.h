@@ -0,0 +1,16 @@
+#ifndef _ASM_RISCV_FPU_H
+#define _ASM_RISCV_FPU_H
+
+#include <linux/types.h>
+
+/*
+ * Bracket kernel code (hand-written assembly; C is built soft-float)
+ * that uses the FP register file.  The region runs with preemption
+ * disabled and must not sleep.  Callers in softirq context check
+ * may_use_fpu() first and fall back to integer code if it is false.
+ */
+extern bool may_use_fpu(void);
+extern void kernel_fpu_begin(void);
+extern void kernel_fpu_end(void);
+
+#endif /* _ASM_RISCV_FPU_H */
@@ -0,0 +1,26 @@
+#ifndef _ASM_RISCV_FTRACE_H
+#define _ASM_RISCV_FTRACE_H
+
+#ifndef __ASSEMBLY__
+
+#include <linux/string.h>
+
+/*
+ * clone and rt_sigreturn are reached through the entry.S wrappers in
+ * sys_call_table; match them to the metadata of the real syscall.
+ */
+#define ARCH_HAS_SYSCALL_MATCH_SYM_NAME
+static inline bool arch_syscall_match_sym_name(const char *sym,
+					       const char *name)
+{
+	size_t len = strlen(name + 3);
+
+	/* Skip the "sys"/"SyS" prefix */
+	if (strncmp(sym + 3, name + 3, len))
+		return false;
+	return sym[len + 3] == '\0' || !strcmp(sym + len + 3, "_wrapper");
+}
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* _ASM_RISCV_FTRACE_H */
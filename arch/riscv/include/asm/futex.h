@@ -0,0 +1,156 @@
+#ifndef _ASM_RISCV_FUTEX_H
+#define _ASM_RISCV_FUTEX_H
+
+#ifdef CONFIG_RV_ATOMIC
+
+#include <linux/futex.h>
+#include <linux/uaccess.h>
+#include <asm/barrier.h>
+#include <asm/errno.h>
+
+/*
+ * The user word is operated on in place with a single AMO, or an LR/SC
+ * loop for cmpxchg, inside one SR_PUM window.  A fault on the user
+ * address is caught through __ex_table and turned into -EFAULT.
+ */
+#define __futex_atomic_op(insn, ret, oldval, uaddr, oparg)	\
+do {								\
+	uintptr_t __tmp;					\
+	__enable_user_access();					\
+	__asm__ __volatile__ (					\
+		"1:\n"						\
+		"	" insn " %1, %z4, %2\n"			\
+		"2:\n"						\
+		"	.section .fixup,\"ax\"\n"		\
+		"	.balign 4\n"				\
+		"3:\n"						\
+		"	li %0, %5\n"				\
+		"	jump 2b, %3\n"				\
+		"	.previous\n"				\
+		"	.section __ex_table,\"a\"\n"		\
+		"	.balign " SZPTR "\n"			\
+		"	" PTR " 1b, 3b\n"			\
+		"	.previous"				\
+		: "+r" (ret), "=&r" (oldval), "+A" (*(uaddr)),	\
+		  "=&r" (__tmp)					\
+		: "rJ" (oparg), "i" (-EFAULT)			\
+		: "memory");					\
+	__disable_user_access();				\
+} while (0)
+
+static inline int futex_atomic_op_inuser(int encoded_op, u32 __user *uaddr)
+{
+	int op = (encoded_op >> 28) & 7;
+	int cmp = (encoded_op >> 24) & 15;
+	int oparg = (encoded_op << 8) >> 20;
+	int cmparg = (encoded_op << 20) >> 20;
+	int oldval = 0, ret = 0;
+
+	if (encoded_op & (FUTEX_OP_OPARG_SHIFT << 28))
+		oparg = 1 << oparg;
+
+	if (!access_ok(VERIFY_WRITE, uaddr, sizeof(u32)))
+		return -EFAULT;
+
+	pagefault_disable();
+	smp_mb();
+
+	switch (op) {
+	case FUTEX_OP_SET:
+		__futex_atomic_op("amoswap.w", ret, oldval, uaddr, oparg);
+		break;
+	case FUTEX_OP_ADD:
+		__futex_atomic_op("amoadd.w", ret, oldval, uaddr, oparg);
+		break;
+	case FUTEX_OP_OR:
+		__futex_atomic_op("amoor.w", ret, oldval, uaddr, oparg);
+		break;
+	case FUTEX_OP_ANDN:
+		__futex_atomic_op("amoand.w", ret, oldval, uaddr, ~oparg);
+		break;
+	case FUTEX_OP_XOR:
+		__futex_atomic_op("amoxor.w", ret, oldval, uaddr, oparg);
+		break;
+	default:
+		ret = -ENOSYS;
+	}
+
+	smp_mb();
+	pagefault_enable();
+
+	if (!ret) {
+		switch (cmp) {
+		case FUTEX_OP_CMP_EQ:
+			ret = (oldval == cmparg);
+			break;
+		case FUTEX_OP_CMP_NE:
+			ret = (oldval != cmparg);
+			break;
+		case FUTEX_OP_CMP_LT:
+			ret = (oldval < cmparg);
+			break;
+		case FUTEX_OP_CMP_GE:
+			ret = (oldval >= cmparg);
+			break;
+		case FUTEX_OP_CMP_LE:
+			ret = (oldval <= cmparg);
+			break;
+		case FUTEX_OP_CMP_GT:
+			ret = (oldval > cmparg);
+			break;
+		default:
+			ret = -ENOSYS;
+		}
+	}
+	return ret;
+}
+
+static inline int futex_atomic_cmpxchg_inatomic(u32 *uval,
+	u32 __user *uaddr, u32 oldval, u32 newval)
+{
+	int ret = 0;
+	u32 val;
+	uintptr_t tmp;
+
+	if (!access_ok(VERIFY_WRITE, uaddr, sizeof(u32)))
+		return -EFAULT;
+
+	/* lr.w sign-extends, so compare against a sign-extended oldval */
+	smp_mb();
+	__enable_user_access();
+	__asm__ __volatile__ (
+		"1:\n"
+		"	lr.w %1, %3\n"
+		"	bne %1, %z4, 3f\n"
+		"2:\n"
+		"	sc.w %2, %z5, %3\n"
+		"	bnez %2, 1b\n"
+		"3:\n"
+		"	.section .fixup,\"ax\"\n"
+		"	.balign 4\n"
+		"4:\n"
+		"	li %0, %6\n"
+		"	jump 3b, %2\n"
+		"	.previous\n"
+		"	.section __ex_table,\"a\"\n"
+		"	.balign " SZPTR "\n"
+		"	" PTR " 1b, 4b\n"
+		"	" PTR " 2b, 4b\n"
+		"	.previous"
+		: "+r" (ret), "=&r" (val), "=&r" (tmp), "+A" (*uaddr)
+		: "rJ" ((long)(int)oldval), "rJ" (newval), "i" (-EFAULT)
+		: "memory");
+	__disable_user_access();
+	smp_mb();
+
+	*uval = val;
+	return ret;
+}
+
+#else /* !CONFIG_RV_ATOMIC */
+
+#include <asm-generic/futex.h>
+
+#endif /* CONFIG_RV_ATOMIC */
+
+#endif /* _ASM_RISCV_FUTEX_H */
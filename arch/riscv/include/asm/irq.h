@@ -6,6 +6,26 @@
 #define IRQ_SOFTWARE    1
 #define IRQ_TIMER       5
 
+#ifndef __ASSEMBLY__
+
+struct pt_regs;
+struct thread_info;
+
+extern struct thread_info *hardirq_ctx[];
+extern struct thread_info *softirq_ctx[];
+
+extern void __do_irq(unsigned int irq, struct pt_regs *regs);
+
+/* Switch to the given IRQ stack; in entry.S */
+extern void call_do_irq(unsigned int irq, struct pt_regs *regs,
+	struct thread_info *irqtp);
+extern void call_do_softirq(struct thread_info *irqtp);
+
+/* Softirqs run on their own stack through do_softirq_own_stack() */
+#define __ARCH_HAS_DO_SOFTIRQ
+
+#endif /* !__ASSEMBLY__ */
+
 #include <asm-generic/irq.h>
 
 #endif /* _ASM_RISCV_IRQ_H */
@@ -3,8 +3,17 @@
 
 #ifndef __ASSEMBLY__
 
+#include <linux/cpumask.h>
+
+struct page;
+
 typedef struct {
 	void *vdso;
+	struct page *vdso_cpu_page;
+#ifdef CONFIG_SMP
+	/* Harts that must fence.i before next running this mm */
+	cpumask_t icache_stale_mask;
+#endif
 } mm_context_t;
 
 #endif /* __ASSEMBLY__ */
@@ -6,6 +6,8 @@
 #include <linux/mm.h>
 #include <linux/sched.h>
 #include <asm/tlbflush.h>
+#include <asm/cacheflush.h>
+#include <asm/vdso.h>
 
 static inline void enter_lazy_tlb(struct mm_struct *mm,
 	struct task_struct *task)
@@ -16,19 +18,88 @@ static inline void enter_lazy_tlb(struct mm_struct *mm,
 static inline int init_new_context(struct task_struct *task,
 	struct mm_struct *mm)
 {
+	struct vdso_mm_data *vdata;
+	struct page *page;
+
+	/* The page is mapped into userspace as [vvar] */
+	page = alloc_page(GFP_KERNEL | __GFP_ZERO);
+	if (unlikely(page == NULL))
+		return -ENOMEM;
+	vdata = page_address(page);
+	vdata->cpu = VDSO_CPU_UNKNOWN;
+	mm->context.vdso_cpu_page = page;
+#ifdef CONFIG_SMP
+	cpumask_clear(&mm->context.icache_stale_mask);
+#endif
 	return 0;
 }
 
 static inline void destroy_context(struct mm_struct *mm)
 {
+	__free_page(mm->context.vdso_cpu_page);
+}
+
+static inline struct vdso_mm_data *vdso_mm_data(struct mm_struct *mm)
+{
+	return page_address(mm->context.vdso_cpu_page);
+}
+
+/*
+ * Publish the current CPU to the vDSO getcpu page.  switch_mm() runs on
+ * every switch to a user task, so this follows the only thread of an
+ * mm across migrations.  With more users the CPU is a per-thread
+ * property, answered from the rseq area or by the kernel.
+ */
+static inline void vdso_cpu_update(struct mm_struct *mm)
+{
+	struct vdso_mm_data *vdata = vdso_mm_data(mm);
+	u32 cpu = VDSO_CPU_UNKNOWN;
+
+	if (atomic_read(&mm->mm_users) == 1)
+		cpu = smp_processor_id();
+	if (READ_ONCE(vdata->cpu) != cpu)
+		WRITE_ONCE(vdata->cpu, cpu);
+}
+
+/*
+ * A new thread is about to share the mm: the published CPU stops being
+ * everyone's answer before the child can run.
+ */
+static inline void vdso_cpu_invalidate(struct mm_struct *mm)
+{
+	WRITE_ONCE(vdso_mm_data(mm)->cpu, VDSO_CPU_UNKNOWN);
+}
+
+/*
+ * Run the fence.i that flush_icache_mm() deferred for this hart.  The
+ * barrier orders our mm_cpumask() update against its read of the mask;
+ * either it sees us and sends an IPI, or we see the stale bit here.
+ */
+static inline void flush_icache_deferred(struct mm_struct *mm,
+	unsigned int cpu)
+{
+#ifdef CONFIG_SMP
+	smp_mb();
+	if (cpumask_test_cpu(cpu, &mm->context.icache_stale_mask)) {
+		cpumask_clear_cpu(cpu, &mm->context.icache_stale_mask);
+		local_flush_icache_all();
+	}
+#endif
 }
 
 static inline void switch_mm(struct mm_struct *prev,
 	struct mm_struct *next, struct task_struct *task)
 {
+	unsigned int cpu = smp_processor_id();
+
+	vdso_cpu_update(next);
 	if (likely(prev != next)) {
+		/* mm_cpumask() holds the harts currently running each mm */
+		cpumask_clear_cpu(cpu, mm_cpumask(prev));
+		cpumask_set_cpu(cpu, mm_cpumask(next));
 		csr_write(sptbr, virt_to_pfn(next->pgd));
 		local_flush_tlb_all();
+		flush_icache_deferred(next, cpu);
 	}
 }
 
@@ -96,14 +96,21 @@ extern unsigned long min_low_pfn;
 #define page_to_bus(page)	(page_to_phys(page))
 #define phys_to_page(paddr)	(pfn_to_page(phys_to_pfn(paddr)))
 
+#ifdef CONFIG_FLATMEM
 #define pfn_valid(pfn)		(((pfn) >= pfn_base) && (((pfn)-pfn_base) < max_mapnr))
 
 #define ARCH_PFN_OFFSET		(pfn_base)
+#endif /* CONFIG_FLATMEM */
 
 #endif /* __ASSEMBLY__ */
 
 #define virt_addr_valid(vaddr)	(pfn_valid(virt_to_pfn(vaddr)))
 
+#ifdef CONFIG_HAVE_ARCH_HUGE_VMAP
+/* Align large ioremap areas so that they can be mapped with megapages */
+#define IOREMAP_MAX_ORDER	(PAGE_SHIFT + 9)
+#endif /* CONFIG_HAVE_ARCH_HUGE_VMAP */
+
 #endif /* __KERNEL__ */
 
 #define VM_DATA_DEFAULT_FLAGS	(VM_READ | VM_WRITE | VM_EXEC | \
@@ -2,8 +2,31 @@
 #define _ASM_RISCV_PGALLOC_H
 
 #include <linux/mm.h>
+#include <linux/quicklist.h>
 #include <asm/tlb.h>
 
+/*
+ * Page global directories are recycled through a per-CPU quicklist.
+ * Pages on it are zero apart from a copy of the kernel half of
+ * init_mm.pgd, which holds for a pgd being freed since the core clears
+ * every user entry first.  Lower-level tables are mostly freed through
+ * tlb_remove_table(), whose RCU callback cannot safely touch a
+ * quicklist, so they come straight from the page allocator.
+ */
+#define QUICK_PGD	0
+
+#define PGT_CACHE_GFP	(GFP_KERNEL | __GFP_REPEAT)
+
+DECLARE_PER_CPU(unsigned long, pgt_cache_allocs);
+
+extern void pgd_ctor(void *pgd);
+
+static inline void *pgt_cache_alloc(int nr, void (*ctor)(void *))
+{
+	this_cpu_inc(pgt_cache_allocs);
+	return quicklist_alloc(nr, PGT_CACHE_GFP, ctor);
+}
+
 static inline void pmd_populate_kernel(struct mm_struct *mm,
 	pmd_t *pmd, pte_t *pte)
 {
@@ -30,22 +53,29 @@ static inline void pud_populate(struct mm_struct *mm, pud_t *pud, pmd_t *pmd)
 
 static inline pgd_t *pgd_alloc(struct mm_struct *mm)
 {
-	pgd_t *pgd;
-
-	pgd = (pgd_t *)__get_free_page(GFP_KERNEL);
-	if (likely(pgd != NULL)) {
-		memset(pgd, 0, USER_PTRS_PER_PGD * sizeof(pgd_t));
-		/* Copy kernel mappings */
-		memcpy(pgd + USER_PTRS_PER_PGD,
-			init_mm.pgd + USER_PTRS_PER_PGD,
-			(PTRS_PER_PGD - USER_PTRS_PER_PGD) * sizeof(pgd_t));
-	}
-	return pgd;
+	return (pgd_t *)pgt_cache_alloc(QUICK_PGD, pgd_ctor);
 }
 
 static inline void pgd_free(struct mm_struct *mm, pgd_t *pgd)
 {
-	free_page((unsigned long)pgd);
+	quicklist_free(QUICK_PGD, NULL, pgd);
+}
+
+/*
+ * A table unlinked during a gather must not be reused until the TLB
+ * flush at its end: harts may cache non-leaf entries, and another hart
+ * may still hold this mm as its lazy active_mm.  tlb_remove_table()
+ * also waits for an RCU-sched grace period, which get_user_pages_fast()
+ * needs, but with fewer than two users it frees at once; those tables
+ * are queued with tlb_remove_page() instead, which frees them only
+ * after the flush.
+ */
+static inline void pgt_free_tlb(struct mmu_gather *tlb, struct page *page)
+{
+	if (atomic_read(&tlb->mm->mm_users) < 2)
+		tlb_remove_page(tlb, page);
+	else
+		tlb_remove_table(tlb, page);
 }
 
 #ifndef __PAGETABLE_PMD_FOLDED
@@ -61,7 +91,8 @@ static inline void pmd_free(struct mm_struct *mm, pmd_t *pmd)
 	free_page((unsigned long)pmd);
 }
 
-#define __pmd_free_tlb(tlb, pmd, addr)  pmd_free((tlb)->mm, pmd)
+#define __pmd_free_tlb(tlb, pmd, addr)	\
+	pgt_free_tlb((tlb), virt_to_page(pmd))
 
 #endif /* __PAGETABLE_PMD_FOLDED */
 
@@ -76,9 +107,13 @@ static inline struct page *pte_alloc_one(struct mm_struct *mm,
 	unsigned long address)
 {
 	struct page *pte;
+
 	pte = alloc_page(GFP_KERNEL | __GFP_REPEAT | __GFP_ZERO);
-	if (likely(pte != NULL)) {
-		pgtable_page_ctor(pte);
+	if (unlikely(pte == NULL))
+		return NULL;
+	if (unlikely(!pgtable_page_ctor(pte))) {
+		__free_page(pte);
+		return NULL;
 	}
 	return pte;
 }
@@ -94,14 +129,16 @@ static inline void pte_free(struct mm_struct *mm, pgtable_t pte)
 	__free_page(pte);
 }
 
-#define __pte_free_tlb(tlb, pte, buf)   \
-do {                                    \
-	pgtable_page_dtor(pte);         \
-	tlb_remove_page((tlb), pte);    \
+#define __pte_free_tlb(tlb, pte, buf)		\
+do {						\
+	pgtable_page_dtor(pte);			\
+	pgt_free_tlb((tlb), (pte));		\
 } while (0)
 
+/* Keep the pgd cache within bounds */
 static inline void check_pgt_cache(void)
 {
+	quicklist_trim(QUICK_PGD, NULL, 25, 16);
 }
 
 #endif /* _ASM_RISCV_PGALLOC_H */
@@ -38,6 +38,14 @@ static inline int pud_bad(pud_t pud)
 	return !pud_present(pud);
 }
 
+/* A present entry of any type other than a table maps a gigapage */
+static inline int pud_leaf(pud_t pud)
+{
+	return pud_present(pud)
+		&& !((pud_val(pud) & _PAGE_TYPE) == _PAGE_TYPE_TABLE
+		     || (pud_val(pud) & _PAGE_TYPE) == _PAGE_TYPE_TABLE_G);
+}
+
 static inline void set_pud(pud_t *pudp, pud_t pud)
 {
 	*pudp = pud;
@@ -53,6 +61,16 @@ static inline unsigned long pud_page_vaddr(pud_t pud)
 	return (unsigned long)pfn_to_virt(pud_val(pud) >> _PAGE_PFN_SHIFT);
 }
 
+static inline pmd_t pfn_pmd(unsigned long pfn, pgprot_t prot)
+{
+	return __pmd((pfn << _PAGE_PFN_SHIFT) | pgprot_val(prot));
+}
+
+static inline pud_t pfn_pud(unsigned long pfn, pgprot_t prot)
+{
+	return __pud((pfn << _PAGE_PFN_SHIFT) | pgprot_val(prot));
+}
+
 #define pmd_index(addr) (((addr) >> PMD_SHIFT) & (PTRS_PER_PMD - 1))
 
 static inline pmd_t *pmd_offset(pud_t *pud, unsigned long addr)
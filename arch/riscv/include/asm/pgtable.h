@@ -89,6 +89,14 @@ static inline int pmd_bad(pmd_t pmd)
 	return !pmd_present(pmd);
 }
 
+/* A present entry of any type other than a table maps a megapage */
+static inline int pmd_leaf(pmd_t pmd)
+{
+	return pmd_present(pmd)
+		&& !((pmd_val(pmd) & _PAGE_TYPE) == _PAGE_TYPE_TABLE
+		     || (pmd_val(pmd) & _PAGE_TYPE) == _PAGE_TYPE_TABLE_G);
+}
+
 static inline void set_pmd(pmd_t *pmdp, pmd_t pmd)
 {
 	*pmdp = pmd;
@@ -294,9 +302,7 @@ static inline void update_mmu_cache(struct vm_area_struct *vma,
 #define __pte_to_swp_entry(pte)	((swp_entry_t) { pte_val(pte) })
 #define __swp_entry_to_pte(x)	((pte_t) { (x).val })
 
-#ifdef CONFIG_FLATMEM
 #define kern_addr_valid(addr)   (1) /* FIXME */
-#endif
 
 extern void paging_init(void);
 
@@ -311,6 +317,20 @@ static inline void pgtable_cache_init(void)
 #define VMALLOC_END      (PAGE_OFFSET - 1)
 #define VMALLOC_START    (PAGE_OFFSET - VMALLOC_SIZE)
 
+#ifdef CONFIG_SPARSEMEM_VMEMMAP
+/*
+ * The virtual memory map sits directly below the vmalloc area and is
+ * sized to cover every page frame below MAX_PHYSMEM_BITS.  Only the
+ * portions that describe populated sections are backed by megapages.
+ */
+#define STRUCT_PAGE_MAX_SHIFT	6
+#define VMEMMAP_SIZE	(_AC(1,UL) << (MAX_PHYSMEM_BITS - PAGE_SHIFT + \
+				       STRUCT_PAGE_MAX_SHIFT))
+#define VMEMMAP_END	(VMALLOC_START)
+#define VMEMMAP_START	(VMALLOC_START - VMEMMAP_SIZE)
+#define vmemmap		((struct page *)VMEMMAP_START)
+#endif /* CONFIG_SPARSEMEM_VMEMMAP */
+
 /* Task size is 0x40000000000 for RV64 or 0xb800000 for RV32.
    Note that PGDIR_SIZE must evenly divide TASK_SIZE. */
 #ifdef CONFIG_64BIT
@@ -34,6 +34,12 @@ struct thread_struct {
 	unsigned long sp;	/* Kernel mode stack */
 	unsigned long s[12];	/* s[0]: frame pointer */
 	struct user_fpregs_struct fstate;
+	unsigned int fpu_cpu;		/* CPU last loaded with fstate */
+	unsigned char fpu_lazy;		/* fstate not loaded; FS forced off */
+	unsigned char fpu_counter;	/* consecutive slices dirtying FP */
+	unsigned char fpu_used;		/* FP touched since exec */
+	struct rseq __user *rseq;	/* Registered by riscv_rseq() */
+	u32 rseq_sig;			/* Signature preceding abort_ip */
 };
 
 #define INIT_THREAD {					\
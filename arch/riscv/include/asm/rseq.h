@@ -0,0 +1,31 @@
+#ifndef _ASM_RISCV_RSEQ_H
+#define _ASM_RISCV_RSEQ_H
+
+#include <linux/sched.h>
+#include <linux/thread_info.h>
+#include <uapi/asm/rseq.h>
+
+struct pt_regs;
+
+extern void rseq_handle_notify_resume(struct pt_regs *regs);
+extern int rseq_signal_deliver(struct pt_regs *regs);
+
+/*
+ * A registered task that is switched out may come back on another CPU,
+ * or after another thread has entered the same per-CPU data; have the
+ * return to userspace check its critical section and refresh cpu_id.
+ */
+static inline void rseq_switch_out(struct task_struct *task)
+{
+	if (task->thread.rseq)
+		set_tsk_thread_flag(task, TIF_NOTIFY_RESUME);
+}
+
+/* Registrations are per thread and belong to the old mm across exec */
+static inline void rseq_clear(struct task_struct *task)
+{
+	task->thread.rseq = NULL;
+	task->thread.rseq_sig = 0;
+}
+
+#endif /* _ASM_RISCV_RSEQ_H */
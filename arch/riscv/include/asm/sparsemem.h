@@ -0,0 +1,20 @@
+#ifndef _ASM_RISCV_SPARSEMEM_H
+#define _ASM_RISCV_SPARSEMEM_H
+
+#ifdef CONFIG_SPARSEMEM
+
+/*
+ * A 128 MiB section holds 32768 pages, whose struct pages occupy
+ * exactly one 2 MiB megapage of the virtual memory map on Sv39.
+ */
+#ifdef CONFIG_64BIT
+#define MAX_PHYSMEM_BITS	38
+#define SECTION_SIZE_BITS	27
+#else
+#define MAX_PHYSMEM_BITS	34
+#define SECTION_SIZE_BITS	26
+#endif /* CONFIG_64BIT */
+
+#endif /* CONFIG_SPARSEMEM */
+
+#endif /* _ASM_RISCV_SPARSEMEM_H */
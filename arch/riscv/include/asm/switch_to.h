@@ -1,16 +1,37 @@
 #ifndef _ASM_RISCV_SWITCH_TO_H
 #define _ASM_RISCV_SWITCH_TO_H
 
+#include <linux/percpu.h>
+#include <linux/smp.h>
 #include <asm/processor.h>
 #include <asm/ptrace.h>
 #include <asm/csr.h>
+#include <asm/rseq.h>
 
 extern void __fstate_save(struct task_struct *);
 extern void __fstate_restore(struct task_struct *);
 
+/*
+ * FP state is restored lazily.  A task is switched in with FS off in its
+ * saved sstatus and fpu_lazy set; its first FP instruction then traps as
+ * illegal and fstate_load() brings in thread.fstate.  fpu_owner records
+ * whose state each CPU's FP registers still hold, so switching back to
+ * that task costs nothing.  Tasks that dirty FP in FPU_EAGER_THRESHOLD
+ * consecutive slices are restored at switch time instead.
+ */
+#define FPU_CPU_NONE		NR_CPUS
+#define FPU_EAGER_THRESHOLD	5
+
+DECLARE_PER_CPU(struct task_struct *, fpu_owner);
+
 static inline void __fstate_clean(struct pt_regs *regs)
 {
-	regs->sstatus |= (regs->sstatus & ~(SR_FS)) | SR_FS_CLEAN;
+	regs->sstatus = (regs->sstatus & ~(SR_FS)) | SR_FS_CLEAN;
+}
+
+static inline void __fstate_off(struct pt_regs *regs)
+{
+	regs->sstatus &= ~(SR_FS);
 }
 
 static inline void fstate_save(struct task_struct *task,
@@ -22,25 +43,73 @@ static inline void fstate_save(struct task_struct *task,
 	}
 }
 
-static inline void fstate_restore(struct task_struct *task,
+/* Load thread.fstate into this CPU's registers; preemption disabled */
+static inline void fstate_load(struct task_struct *task,
+                               struct pt_regs *regs)
+{
+	__fstate_restore(task);
+	__fstate_clean(regs);
+	task->thread.fpu_lazy = 0;
+	task->thread.fpu_used = 1;
+	task->thread.fpu_cpu = smp_processor_id();
+	this_cpu_write(fpu_owner, task);
+}
+
+/*
+ * Drop any live copy of the task's FP state ahead of thread.fstate
+ * being rewritten; the new contents are loaded on next use.
+ */
+static inline void fstate_discard(struct task_struct *task,
                                   struct pt_regs *regs)
 {
-	if ((regs->sstatus & SR_FS) != SR_FS_OFF) {
-		__fstate_restore(task);
+	if ((regs->sstatus & SR_FS) != SR_FS_OFF || task->thread.fpu_lazy) {
+		__fstate_off(regs);
+		task->thread.fpu_lazy = 1;
+	}
+	task->thread.fpu_cpu = FPU_CPU_NONE;
+}
+
+static inline void fstate_switch_out(struct task_struct *task,
+                                     struct pt_regs *regs)
+{
+	if (unlikely(regs->sstatus & SR_SD) &&
+	    (regs->sstatus & SR_FS) == SR_FS_DIRTY) {
+		__fstate_save(task);
 		__fstate_clean(regs);
+		if (task->thread.fpu_counter < FPU_EAGER_THRESHOLD)
+			task->thread.fpu_counter++;
+	} else {
+		task->thread.fpu_counter = 0;
 	}
 }
 
-static inline void __switch_to_aux(struct task_struct *prev,
-                                   struct task_struct *next)
+static inline void fstate_switch_in(struct task_struct *task,
+                                    struct pt_regs *regs)
 {
-	struct pt_regs *regs;
+	unsigned int cpu = smp_processor_id();
+
+	/* No FP context, e.g. a kernel thread */
+	if ((regs->sstatus & SR_FS) == SR_FS_OFF && !task->thread.fpu_lazy)
+		return;
 
-	regs = task_pt_regs(prev);
-	if (unlikely(regs->sstatus & SR_SD)) {
-		fstate_save(prev, regs);
+	if (per_cpu(fpu_owner, cpu) == task && task->thread.fpu_cpu == cpu) {
+		/* The registers still hold thread.fstate */
+		__fstate_clean(regs);
+		task->thread.fpu_lazy = 0;
+	} else if (task->thread.fpu_counter >= FPU_EAGER_THRESHOLD) {
+		fstate_load(task, regs);
+	} else {
+		__fstate_off(regs);
+		task->thread.fpu_lazy = 1;
 	}
-	fstate_restore(next, task_pt_regs(next));
+}
+
+static inline void __switch_to_aux(struct task_struct *prev,
+                                   struct task_struct *next)
+{
+	fstate_switch_out(prev, task_pt_regs(prev));
+	rseq_switch_out(prev);
+	fstate_switch_in(next, task_pt_regs(next));
 }
 
 extern struct task_struct *__switch_to(struct task_struct *,
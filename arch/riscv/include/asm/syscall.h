@@ -75,7 +75,7 @@ static inline void syscall_get_arguments(struct task_struct *task,
 					 unsigned long *args)
 {
 	BUG_ON(i + n > 6);
-	memcpy(args, &regs->a0 + i * sizeof(regs->a0), n * sizeof(args[0]));
+	memcpy(args, &regs->a0 + i, n * sizeof(args[0]));
 }
 
 static inline void syscall_set_arguments(struct task_struct *task,
@@ -84,7 +84,7 @@ static inline void syscall_set_arguments(struct task_struct *task,
 					 const unsigned long *args)
 {
 	BUG_ON(i + n > 6);
-	memcpy(&regs->a0 + i * sizeof(regs->a0), args, n * sizeof(regs->a0));
+	memcpy(&regs->a0 + i, args, n * sizeof(regs->a0));
 }
 
 #endif	/* _ASM_TILE_SYSCALL_H */
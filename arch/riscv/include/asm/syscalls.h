@@ -2,11 +2,24 @@
 #define _ASM_RISCV_SYSCALLS_H
 
 #include <linux/linkage.h>
+#include <linux/types.h>
+
+struct rseq;
 
 #include <asm-generic/syscalls.h>
 
+/* kernel/entry.S */
+asmlinkage long sys_clone_wrapper(unsigned long, unsigned long,
+	unsigned long, unsigned long, unsigned long);
+asmlinkage long sys_rt_sigreturn_wrapper(void);
+
 /* kernel/sys_riscv.c */
 asmlinkage long sys_sysriscv(unsigned long, unsigned long,
 	unsigned long, unsigned long);
+asmlinkage long sys_riscv_flush_icache(unsigned long, unsigned long,
+	unsigned long);
+
+/* kernel/rseq.c */
+asmlinkage long sys_riscv_rseq(struct rseq __user *, u32, int, u32);
 
 #endif /* _ASM_RISCV_SYSCALLS_H */
@@ -30,6 +30,12 @@ struct thread_info {
 	__u32			cpu;		/* current CPU */
 	int                     preempt_count;  /* 0 => preemptable, <0 => BUG */
 	mm_segment_t		addr_limit;
+#ifdef CONFIG_VIRT_CPU_ACCOUNTING_NATIVE
+	/* Time CSR stamps kept by entry.S, in timebase ticks */
+	unsigned long		ac_stamp;	/* last user/kernel transition */
+	unsigned long		ac_utime;	/* user time not yet accounted */
+	unsigned long		ac_stime;	/* system time not yet accounted */
+#endif
 };
 
 /*
@@ -75,15 +81,22 @@ static inline struct thread_info *current_thread_info(void)
 #define TIF_RESTORE_SIGMASK	4	/* restore signal mask in do_signal() */
 #define TIF_MEMDIE		5	/* is terminating due to OOM killer */
 #define TIF_SYSCALL_TRACEPOINT  6       /* syscall tracepoint instrumentation */
+#define TIF_NOHZ		7	/* in adaptive nohz mode */
 
 #define _TIF_SYSCALL_TRACE	(1 << TIF_SYSCALL_TRACE)
 #define _TIF_NOTIFY_RESUME	(1 << TIF_NOTIFY_RESUME)
 #define _TIF_SIGPENDING		(1 << TIF_SIGPENDING)
 #define _TIF_NEED_RESCHED	(1 << TIF_NEED_RESCHED)
+#define _TIF_SYSCALL_TRACEPOINT	(1 << TIF_SYSCALL_TRACEPOINT)
+#define _TIF_NOHZ		(1 << TIF_NOHZ)
 
 #define _TIF_WORK_MASK \
 	(_TIF_NOTIFY_RESUME | _TIF_SIGPENDING | _TIF_NEED_RESCHED)
 
+/* Work that forces system calls off the fast path */
+#define _TIF_SYSCALL_WORK \
+	(_TIF_SYSCALL_TRACE | _TIF_SYSCALL_TRACEPOINT | _TIF_NOHZ)
+
 #endif /* __KERNEL__ */
 
 #endif /* _ASM_RISCV_THREAD_INFO_H */
@@ -7,10 +7,10 @@
 
 typedef unsigned long cycles_t;
 
-static inline cycles_t get_cycles(void)
+static inline u64 get_cycles64(void)
 {
 #ifdef __riscv64
-	cycles_t n;
+	u64 n;
 	__asm__ __volatile__ (
 		"csrr %0, stime"
 		: "=r" (n));
@@ -28,6 +28,11 @@ static inline cycles_t get_cycles(void)
 #endif
 }
 
+static inline cycles_t get_cycles(void)
+{
+	return get_cycles64();
+}
+
 #define ARCH_HAS_READ_CURRENT_TIMER
 
 static inline int read_current_timer(unsigned long *timer_val)
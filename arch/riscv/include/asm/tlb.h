@@ -1,6 +1,18 @@
 #ifndef _ASM_RISCV_TLB_H
 #define _ASM_RISCV_TLB_H
 
+#include <linux/gfp.h>
+
+/*
+ * Page-table pages reach here through tlb_remove_table() once an
+ * RCU-sched grace period has passed, so no lockless walker in
+ * get_user_pages_fast() can still be looking at them.
+ */
+static inline void __tlb_remove_table(void *table)
+{
+	__free_page((struct page *)table);
+}
+
 #include <asm-generic/tlb.h>
 
 static inline void tlb_flush(struct mmu_gather *tlb)
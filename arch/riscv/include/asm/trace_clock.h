@@ -0,0 +1,13 @@
+#ifndef _ASM_RISCV_TRACE_CLOCK_H
+#define _ASM_RISCV_TRACE_CLOCK_H
+
+#include <linux/compiler.h>
+#include <linux/types.h>
+
+/* Raw time CSR ticks; consistent across harts */
+extern u64 notrace trace_clock_riscv_rdtime(void);
+
+#define ARCH_TRACE_CLOCKS \
+	{ trace_clock_riscv_rdtime,	"rdtime",	.in_ns = 0 },
+
+#endif /* _ASM_RISCV_TRACE_CLOCK_H */
@@ -11,8 +11,10 @@
 #include <asm/asm.h>
 
 #ifdef CONFIG_RV_PUM
-#define __enable_user_access() __asm__ ("csrc sstatus, %0" : : "r" (SR_PUM))
-#define __disable_user_access() __asm__ ("csrs sstatus, %0" : : "r" (SR_PUM))
+#define __enable_user_access() \
+	__asm__ __volatile__ ("csrc sstatus, %0" : : "r" (SR_PUM) : "memory")
+#define __disable_user_access() \
+	__asm__ __volatile__ ("csrs sstatus, %0" : : "r" (SR_PUM) : "memory")
 #else
 #define __enable_user_access()
 #define __disable_user_access()
@@ -117,7 +119,6 @@ extern int fixup_exception(struct pt_regs *);
 #define __get_user_asm(insn, x, ptr, err)			\
 do {								\
 	uintptr_t __tmp;					\
-	__enable_user_access();					\
 	__asm__ __volatile__ (					\
 		"1:\n"						\
 		"	" insn " %1, %3\n"			\
@@ -135,7 +136,6 @@ do {								\
 		"	.previous"				\
 		: "+r" (err), "=&r" (x), "=r" (__tmp)		\
 		: "m" (*(ptr)), "i" (-EFAULT));			\
-	__disable_user_access();				\
 } while (0)
 #else /* !CONFIG_MMU */
 #define __get_user_asm(insn, x, ptr, err)			\
@@ -156,7 +156,6 @@ do {								\
 	u32 __user *__ptr = (u32 __user *)(ptr);		\
 	u32 __lo, __hi;						\
 	uintptr_t __tmp;					\
-	__enable_user_access();					\
 	__asm__ __volatile__ (					\
 		"1:\n"						\
 		"	lw %1, %4\n"				\
@@ -180,7 +179,6 @@ do {								\
 			"=r" (__tmp)				\
 		: "m" (__ptr[__LSW]), "m" (__ptr[__MSW]),	\
 			"i" (-EFAULT));				\
-	__disable_user_access();				\
 	(x) = (__typeof__(x))((__typeof__((x)-(x)))(		\
 		(((u64)__hi << 32) | __lo)));			\
 } while (0)
@@ -191,6 +189,27 @@ do {								\
 #endif /* CONFIG_64BIT */
 
 
+/* The access itself; SR_PUM must already be clear */
+#define __get_user_nocheck(x, __gu_ptr, __gu_err)		\
+do {								\
+	switch (sizeof(*__gu_ptr)) {				\
+	case 1:							\
+		__get_user_asm("lb", (x), __gu_ptr, __gu_err);	\
+		break;						\
+	case 2:							\
+		__get_user_asm("lh", (x), __gu_ptr, __gu_err);	\
+		break;						\
+	case 4:							\
+		__get_user_asm("lw", (x), __gu_ptr, __gu_err);	\
+		break;						\
+	case 8:							\
+		__get_user_8((x), __gu_ptr, __gu_err);		\
+		break;						\
+	default:						\
+		BUILD_BUG();					\
+	}							\
+} while (0)
+
 /**
  * __get_user: - Get a simple variable from user space, with less checking.
  * @x:   Variable to store result.
@@ -216,22 +235,9 @@ do {								\
 	register int __gu_err = 0;				\
 	const __typeof__(*(ptr)) __user *__gu_ptr = (ptr);	\
 	__chk_user_ptr(__gu_ptr);				\
-	switch (sizeof(*__gu_ptr)) {				\
-	case 1:							\
-		__get_user_asm("lb", (x), __gu_ptr, __gu_err);	\
-		break;						\
-	case 2:							\
-		__get_user_asm("lh", (x), __gu_ptr, __gu_err);	\
-		break;						\
-	case 4:							\
-		__get_user_asm("lw", (x), __gu_ptr, __gu_err);	\
-		break;						\
-	case 8:							\
-		__get_user_8((x), __gu_ptr, __gu_err);	\
-		break;						\
-	default:						\
-		BUILD_BUG();					\
-	}							\
+	__enable_user_access();					\
+	__get_user_nocheck((x), __gu_ptr, __gu_err);		\
+	__disable_user_access();				\
 	__gu_err;						\
 })
 
@@ -266,7 +272,6 @@ do {								\
 #define __put_user_asm(insn, x, ptr, err)			\
 do {								\
 	uintptr_t __tmp;					\
-	__enable_user_access();					\
 	__asm__ __volatile__ (					\
 		"1:\n"						\
 		"	" insn " %z3, %2\n"			\
@@ -283,7 +288,6 @@ do {								\
 		"	.previous"				\
 		: "+r" (err), "=r" (__tmp), "=m" (*(ptr))	\
 		: "rJ" (x), "i" (-EFAULT));			\
-	__disable_user_access();				\
 } while (0)
 #else /* !CONFIG_MMU */
 #define __put_user_asm(insn, x, ptr, err)			\
@@ -304,7 +308,6 @@ do {								\
 	u32 __user *__ptr = (u32 __user *)(ptr);		\
 	u64 __x = (__typeof__((x)-(x)))(x);	 		\
 	uintptr_t __tmp;					\
-	__enable_user_access();					\
 	__asm__ __volatile__ (					\
 		"1:\n"						\
 		"	sw %z4, %2\n"				\
@@ -326,7 +329,6 @@ do {								\
 			"=m" (__ptr[__LSW]),			\
 			"=m" (__ptr[__MSW])			\
 		: "rJ" (__x), "rJ" (__x >> 32), "i" (-EFAULT));	\
-	__disable_user_access();				\
 } while (0)
 #else /* !CONFIG_MMU */
 #define __put_user_8(x, ptr, err)				\
@@ -335,6 +337,27 @@ do {								\
 #endif /* CONFIG_64BIT */
 
 
+/* The access itself; SR_PUM must already be clear */
+#define __put_user_nocheck(x, __gu_ptr, __pu_err)		\
+do {								\
+	switch (sizeof(*__gu_ptr)) {				\
+	case 1:							\
+		__put_user_asm("sb", (x), __gu_ptr, __pu_err);	\
+		break;						\
+	case 2:							\
+		__put_user_asm("sh", (x), __gu_ptr, __pu_err);	\
+		break;						\
+	case 4:							\
+		__put_user_asm("sw", (x), __gu_ptr, __pu_err);	\
+		break;						\
+	case 8:							\
+		__put_user_8((x), __gu_ptr, __pu_err);		\
+		break;						\
+	default:						\
+		BUILD_BUG();					\
+	}							\
+} while (0)
+
 /**
  * __put_user: - Write a simple value into user space, with less checking.
  * @x:   Value to copy to user space.
@@ -359,22 +382,9 @@ do {								\
 	register int __pu_err = 0;				\
 	__typeof__(*(ptr)) __user *__gu_ptr = (ptr);		\
 	__chk_user_ptr(__gu_ptr);				\
-	switch (sizeof(*__gu_ptr)) {				\
-	case 1:							\
-		__put_user_asm("sb", (x), __gu_ptr, __pu_err);	\
-		break;						\
-	case 2:							\
-		__put_user_asm("sh", (x), __gu_ptr, __pu_err);	\
-		break;						\
-	case 4:							\
-		__put_user_asm("sw", (x), __gu_ptr, __pu_err);	\
-		break;						\
-	case 8:							\
-		__put_user_8((x), __gu_ptr, __pu_err);	\
-		break;						\
-	default:						\
-		BUILD_BUG();					\
-	}							\
+	__enable_user_access();					\
+	__put_user_nocheck((x), __gu_ptr, __pu_err);		\
+	__disable_user_access();				\
 	__pu_err;						\
 })
 
@@ -404,6 +414,39 @@ do {								\
 })
 
 
+/*
+ * Batched user access.  user_access_begin() clears SR_PUM once for a run
+ * of unsafe_get_user()/unsafe_put_user() calls, which then skip the
+ * per-access CSR writes, and user_access_end() sets it again.  As with
+ * __get_user(), the range must already have passed access_ok().  Code
+ * inside the window must not sleep or call anything that toggles SR_PUM
+ * itself, such as __copy_user().
+ *
+ * unsafe_get_user() and unsafe_put_user() return zero or -EFAULT, like
+ * __get_user() and __put_user().
+ */
+#define user_access_begin()	__enable_user_access()
+#define user_access_end()	__disable_user_access()
+
+#define unsafe_get_user(x, ptr)					\
+({								\
+	register int __gu_err = 0;				\
+	const __typeof__(*(ptr)) __user *__gu_ptr = (ptr);	\
+	__chk_user_ptr(__gu_ptr);				\
+	__get_user_nocheck((x), __gu_ptr, __gu_err);		\
+	__builtin_expect(__gu_err, 0);				\
+})
+
+#define unsafe_put_user(x, ptr)					\
+({								\
+	register int __pu_err = 0;				\
+	__typeof__(*(ptr)) __user *__gu_ptr = (ptr);		\
+	__chk_user_ptr(__gu_ptr);				\
+	__put_user_nocheck((x), __gu_ptr, __pu_err);		\
+	__builtin_expect(__pu_err, 0);				\
+})
+
+
 extern unsigned long __must_check __copy_user(void __user *to,
 	const void __user *from, unsigned long n);
 
@@ -1,11 +1,65 @@
 #ifndef _ASM_RISCV_VDSO_H
 #define _ASM_RISCV_VDSO_H
 
+#include <linux/threads.h>
 #include <linux/types.h>
 
+#ifndef __ASSEMBLY__
+
+/*
+ * Timekeeping state shared with the vDSO.  The data page is mapped
+ * read-only immediately below the vDSO text.
+ */
 struct vdso_data {
+	u32 seq_count;		/* Odd while an update is in progress */
+	u32 use_syscall;	/* Clocksource is not readable from userspace */
+	u64 cs_cycle_last;	/* Timebase at the last update */
+	u64 cs_mask;		/* Clocksource mask */
+	u32 cs_mult;		/* Clocksource multiplier */
+	u32 cs_shift;		/* Clocksource shift */
+	u64 xtime_clock_sec;	/* CLOCK_REALTIME seconds */
+	u64 xtime_clock_nsec;	/* CLOCK_REALTIME shifted nanoseconds */
+	u64 xtime_coarse_sec;	/* CLOCK_REALTIME_COARSE seconds */
+	u64 xtime_coarse_nsec;	/* CLOCK_REALTIME_COARSE nanoseconds */
+	u64 wtm_clock_sec;	/* Wall to monotonic offset seconds */
+	u64 wtm_clock_nsec;	/* Wall to monotonic offset nanoseconds */
+	u32 tz_minuteswest;	/* sys_tz for gettimeofday */
+	u32 tz_dsttime;
+	u32 hrtimer_res;	/* CLOCK_{REALTIME,MONOTONIC} resolution */
+	u32 cpu_node[NR_CPUS];	/* NUMA node of each CPU, for getcpu */
+};
+
+/*
+ * Each mm also has a private page below the data page.  cpu holds the
+ * CPU its only thread last ran on, or VDSO_CPU_UNKNOWN.  Threaded
+ * processes are served through their rseq areas instead: once a thread
+ * registers with RSEQ_FLAG_TP_RELATIVE, rseq_tp_offset gives the
+ * location of every thread's struct rseq relative to its tp.
+ */
+#define VDSO_CPU_UNKNOWN	(~0U)
+
+#define VDSO_RSEQ_TP_NONE	0	/* No tp-relative registration yet */
+#define VDSO_RSEQ_TP_VALID	1	/* rseq_tp_offset holds for all threads */
+#define VDSO_RSEQ_TP_CONFLICT	2	/* Threads disagreed; use the syscall */
+
+struct vdso_mm_data {
+	u32 cpu;
+	u32 rseq_tp_state;
+	long rseq_tp_offset;
 };
 
+struct pt_regs;
+
+extern bool vdso_emulate_rdtime(struct pt_regs *regs, u32 insn);
+
+#ifndef CONFIG_RV_ATOMIC
+extern void vdso_ras_fixup(struct pt_regs *regs);
+#else
+static inline void vdso_ras_fixup(struct pt_regs *regs) { }
+#endif
+
+#endif /* __ASSEMBLY__ */
+
 #define VDSO_SYMBOL(base, name)					\
 ({								\
 	extern const char __vdso_##name[];			\
@@ -0,0 +1,43 @@
+#ifndef _UAPI_ASM_RISCV_RSEQ_H
+#define _UAPI_ASM_RISCV_RSEQ_H
+
+#include <linux/types.h>
+
+/*
+ * Restartable sequences.  A thread registers one struct rseq with
+ * riscv_rseq().  The kernel keeps cpu_id_start and cpu_id current, and
+ * if the thread is preempted, migrated or interrupted by a signal while
+ * its pc lies in [start_ip, start_ip + post_commit_offset) of the
+ * critical section that rseq_cs points to, it resumes at abort_ip
+ * instead.  The 32-bit word before abort_ip must hold the signature
+ * given at registration.
+ */
+
+#define RSEQ_FLAG_UNREGISTER	(1 << 0)
+
+/*
+ * Registration flag: every thread of this process keeps its struct rseq
+ * at the same offset from tp, with cpu_id set to
+ * RSEQ_CPU_ID_UNINITIALIZED until it registers.  The vDSO getcpu can
+ * then read the CPU from the calling thread's area.
+ */
+#define RSEQ_FLAG_TP_RELATIVE	(1 << 1)
+
+#define RSEQ_CPU_ID_UNINITIALIZED	(-1)
+
+struct rseq_cs {
+	__u32 version;		/* Must be 0 */
+	__u32 flags;		/* Must be 0 */
+	__u64 start_ip;
+	__u64 post_commit_offset;
+	__u64 abort_ip;
+} __attribute__((aligned(4 * sizeof(__u64))));
+
+struct rseq {
+	__u32 cpu_id_start;	/* CPU, always valid */
+	__u32 cpu_id;		/* CPU, or RSEQ_CPU_ID_UNINITIALIZED */
+	__u64 rseq_cs;		/* Active struct rseq_cs, or 0 */
+	__u32 flags;		/* Must be 0 */
+} __attribute__((aligned(4 * sizeof(__u64))));
+
+#endif /* _UAPI_ASM_RISCV_RSEQ_H */
@@ -0,0 +1,14 @@
+#ifndef _UAPI_ASM_RISCV_UCONTEXT_H
+#define _UAPI_ASM_RISCV_UCONTEXT_H
+
+/*
+ * uc_flags: uc_mcontext.sc_fpregs holds FP state.  It is set when the
+ * task had used FP by the time the frame was set up; otherwise
+ * sc_fpregs is left unwritten.  sigreturn only reads sc_fpregs when the
+ * bit is set, so a handler that wants to supply FP state must set it.
+ */
+#define UC_FP_STATE	0x1
+
+#include <asm-generic/ucontext.h>
+
+#endif /* _UAPI_ASM_RISCV_UCONTEXT_H */
@@ -5,5 +5,11 @@
 __SYSCALL(__NR_sysriscv, sys_sysriscv)
 #endif
 
+#define __NR_riscv_rseq  (__NR_arch_specific_syscall + 1)
+__SYSCALL(__NR_riscv_rseq, sys_riscv_rseq)
+
+#define __NR_riscv_flush_icache  (__NR_arch_specific_syscall + 2)
+__SYSCALL(__NR_riscv_flush_icache, sys_riscv_flush_icache)
+
 #define RISCV_ATOMIC_CMPXCHG    1
 #define RISCV_ATOMIC_CMPXCHG64  2
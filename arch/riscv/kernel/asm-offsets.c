@@ -24,6 +24,12 @@ void asm_offsets(void)
 	OFFSET(TI_TASK, thread_info, task);
 	OFFSET(TI_FLAGS, thread_info, flags);
 	OFFSET(TI_CPU, thread_info, cpu);
+	OFFSET(TI_PREEMPT_COUNT, thread_info, preempt_count);
+#ifdef CONFIG_VIRT_CPU_ACCOUNTING_NATIVE
+	OFFSET(TI_AC_STAMP, thread_info, ac_stamp);
+	OFFSET(TI_AC_UTIME, thread_info, ac_utime);
+	OFFSET(TI_AC_STIME, thread_info, ac_stime);
+#endif
 
 	OFFSET(THREAD_F0,  task_struct, thread.fstate.f[0]);
 	OFFSET(THREAD_F1,  task_struct, thread.fstate.f[1]);
@@ -0,0 +1,67 @@
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/hardirq.h>
+#include <linux/percpu.h>
+#include <linux/export.h>
+
+#include <asm/fpu.h>
+#include <asm/switch_to.h>
+#include <asm/csr.h>
+
+/* Set while kernel code owns this CPU's FP registers */
+static DEFINE_PER_CPU(bool, kernel_fpu_busy);
+
+/* Whether current's user FP state was moved out of the way */
+static DEFINE_PER_CPU(bool, kernel_fpu_saved);
+
+/*
+ * Hard interrupts may land in the middle of an FP register save or
+ * restore, so only process and softirq context may use the FPU.  Code
+ * in process context that touches the FP registers with interrupts
+ * enabled (fstate_save) does so in one go, which a softirq can preserve
+ * by saving and restoring around its own use.
+ */
+bool may_use_fpu(void)
+{
+	return !in_irq() && !in_nmi() && !this_cpu_read(kernel_fpu_busy);
+}
+EXPORT_SYMBOL_GPL(may_use_fpu);
+
+void kernel_fpu_begin(void)
+{
+	struct task_struct *task = current;
+	struct pt_regs *regs = task_pt_regs(task);
+
+	preempt_disable();
+	WARN_ON_ONCE(!may_use_fpu());
+	this_cpu_write(kernel_fpu_busy, true);
+
+	/*
+	 * A task's user state is live in the registers exactly when FS is
+	 * on in its saved sstatus.  Keep a copy in thread.fstate to put
+	 * back afterwards; otherwise the registers belong to whichever
+	 * task last owned them, which must reload on its next use.
+	 */
+	if ((regs->sstatus & SR_FS) != SR_FS_OFF) {
+		__fstate_save(task);
+		this_cpu_write(kernel_fpu_saved, true);
+	} else {
+		this_cpu_write(fpu_owner, NULL);
+		this_cpu_write(kernel_fpu_saved, false);
+	}
+
+	csr_set(sstatus, SR_FS);
+}
+EXPORT_SYMBOL_GPL(kernel_fpu_begin);
+
+void kernel_fpu_end(void)
+{
+	csr_clear(sstatus, SR_FS);
+
+	if (this_cpu_read(kernel_fpu_saved))
+		__fstate_restore(current);
+
+	this_cpu_write(kernel_fpu_busy, false);
+	preempt_enable();
+}
+EXPORT_SYMBOL_GPL(kernel_fpu_end);
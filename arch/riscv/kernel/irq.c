@@ -1,20 +1,104 @@
 #include <linux/interrupt.h>
 #include <linux/ftrace.h>
 #include <linux/seq_file.h>
+#include <linux/debugfs.h>
+#include <linux/gfp.h>
 
 #include <asm/ptrace.h>
 #include <asm/sbi.h>
 #include <asm/smp.h>
+#include <asm/uaccess.h>
+#include <asm/debug.h>
 
-asmlinkage void __irq_entry do_IRQ(unsigned int irq, struct pt_regs *regs)
+/*
+ * Per-CPU hardirq and softirq stacks.  Each is THREAD_SIZE-aligned with a
+ * thread_info at the bottom, like a task stack, so that entry.S and
+ * current_thread_info() work unchanged on them.
+ */
+struct thread_info *hardirq_ctx[NR_CPUS] __read_mostly;
+struct thread_info *softirq_ctx[NR_CPUS] __read_mostly;
+
+/* Borrow the interrupted context's identity for the duration */
+static void irq_ctx_enter(struct thread_info *irqtp, struct thread_info *curtp)
+{
+	irqtp->task = curtp->task;
+	irqtp->flags = 0;
+	irqtp->preempt_count = curtp->preempt_count;
+	irqtp->addr_limit = curtp->addr_limit;
+}
+
+/* Hand back any flags set through current_thread_info() meanwhile */
+static void irq_ctx_exit(struct thread_info *irqtp, struct thread_info *curtp)
+{
+	unsigned int bit;
+
+	irqtp->task = NULL;
+	for_each_set_bit(bit, &irqtp->flags, BITS_PER_LONG)
+		set_bit(bit, &curtp->flags);
+}
+
+void __do_irq(unsigned int irq, struct pt_regs *regs)
 {
-	struct pt_regs *old_regs = set_irq_regs(regs);
 	irq_enter();
 	generic_handle_irq(irq);
 	irq_exit();
+}
+
+asmlinkage void __irq_entry do_IRQ(unsigned int irq, struct pt_regs *regs)
+{
+	struct pt_regs *old_regs = set_irq_regs(regs);
+	struct thread_info *curtp, *irqtp;
+
+	curtp = current_thread_info();
+	irqtp = hardirq_ctx[raw_smp_processor_id()];
+
+	/* Already there, e.g. for softirqs run from irq_exit() */
+	if (unlikely(curtp == irqtp)) {
+		__do_irq(irq, regs);
+	} else {
+		irq_ctx_enter(irqtp, curtp);
+		call_do_irq(irq, regs, irqtp);
+		irq_ctx_exit(irqtp, curtp);
+	}
+
 	set_irq_regs(old_regs);
 }
 
+void do_softirq_own_stack(void)
+{
+	struct thread_info *curtp, *irqtp;
+
+	curtp = current_thread_info();
+	irqtp = softirq_ctx[smp_processor_id()];
+
+	irq_ctx_enter(irqtp, curtp);
+	call_do_softirq(irqtp);
+	irq_ctx_exit(irqtp, curtp);
+}
+
+static struct thread_info * __init irq_ctx_alloc(unsigned int cpu)
+{
+	struct thread_info *ti;
+
+	/* Zeroed so that the high-water mark can be found later */
+	ti = (struct thread_info *)__get_free_pages(GFP_KERNEL | __GFP_ZERO,
+						    THREAD_SIZE_ORDER);
+	BUG_ON(ti == NULL);
+	ti->cpu = cpu;
+	ti->addr_limit = KERNEL_DS;
+	return ti;
+}
+
+static void __init irq_ctx_init(void)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		hardirq_ctx[cpu] = irq_ctx_alloc(cpu);
+		softirq_ctx[cpu] = irq_ctx_alloc(cpu);
+	}
+}
+
 static void riscv_irq_mask(struct irq_data *d)
 {
 	unsigned long ret = sbi_mask_interrupt(d->irq);
@@ -38,6 +122,8 @@ void __init init_IRQ(void)
 {
 	int ret;
 
+	irq_ctx_init();
+
 	ret = irq_alloc_desc_at(IRQ_TIMER, numa_node_id());
 	BUG_ON(ret < 0);
 	irq_set_chip_and_handler(IRQ_TIMER, &riscv_irq_chip, handle_level_irq);
@@ -52,3 +138,53 @@ void __init init_IRQ(void)
 	BUG_ON(ret != 0);
 #endif
 }
+
+#ifdef CONFIG_DEBUG_FS
+/* Deepest use so far: stacks grow down towards the zeroed region */
+static unsigned long irq_stack_used(struct thread_info *ti)
+{
+	unsigned long *n = (unsigned long *)(ti + 1);
+	unsigned long *end = (unsigned long *)((void *)ti + THREAD_SIZE);
+
+	while (n < end && !*n)
+		n++;
+	return (unsigned long)end - (unsigned long)n;
+}
+
+static int irq_stack_show(struct seq_file *m, void *v)
+{
+	int cpu;
+
+	seq_printf(m, "cpu  hardirq  softirq  (of %lu bytes)\n",
+		THREAD_SIZE - sizeof(struct thread_info));
+	for_each_possible_cpu(cpu) {
+		seq_printf(m, "%3d %8lu %8lu\n", cpu,
+			irq_stack_used(hardirq_ctx[cpu]),
+			irq_stack_used(softirq_ctx[cpu]));
+	}
+	return 0;
+}
+
+static int irq_stack_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_stack_show, NULL);
+}
+
+static const struct file_operations irq_stack_fops = {
+	.open		= irq_stack_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init irq_stack_debugfs_init(void)
+{
+	if (!riscv_debugfs_root)
+		return -ENODEV;
+	if (!debugfs_create_file("irq_stack_usage", S_IRUGO,
+			riscv_debugfs_root, NULL, &irq_stack_fops))
+		return -ENOMEM;
+	return 0;
+}
+device_initcall(irq_stack_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
@@ -9,10 +9,14 @@
 #include <asm/csr.h>
 #include <asm/string.h>
 #include <asm/switch_to.h>
+#include <asm/rseq.h>
+#include <asm/mmu_context.h>
 
 extern asmlinkage void ret_from_fork(void);
 extern asmlinkage void ret_from_kernel_thread(void);
 
+DEFINE_PER_CPU(struct task_struct *, fpu_owner);
+
 void arch_cpu_idle(void)
 {
 	wait_for_interrupt();
@@ -53,7 +57,9 @@ void show_regs(struct pt_regs *regs)
 void start_thread(struct pt_regs *regs, unsigned long pc, 
 	unsigned long sp)
 {
-	regs->sstatus = SR_PIE /* User mode, irqs on */ | SR_FS_INITIAL;
+	/* FS stays off until the first FP instruction loads fstate */
+	regs->sstatus = SR_PIE; /* User mode, irqs on */
+	current->thread.fpu_lazy = 1;
 	regs->sepc = pc;
 	regs->sp = sp;
 	set_fs(USER_DS);
@@ -65,14 +71,20 @@ void flush_thread(void)
 	 *	frm: round to nearest, ties to even (IEEE default)
 	 *	fflags: accrued exceptions cleared
 	 */
+	fstate_discard(current, task_pt_regs(current));
 	memset(&current->thread.fstate, 0,
 		sizeof(struct user_fpregs_struct));
+	current->thread.fpu_counter = 0;
+	current->thread.fpu_used = 0;
+	rseq_clear(current);
 }
 
 int arch_dup_task_struct(struct task_struct *dst, struct task_struct *src)
 {
 	fstate_save(src, task_pt_regs(src));
 	*dst = *src;
+	/* The child's fstate is not live in any CPU's registers */
+	dst->thread.fpu_cpu = FPU_CPU_NONE;
 	return 0;
 }
 
@@ -99,6 +111,11 @@ int copy_thread(unsigned long clone_flags, unsigned long usp,
 		if (clone_flags & CLONE_SETTLS)
 			childregs->tp = childregs->a5;
 		childregs->a0 = 0; /* Return value of fork() */
+		/* A new thread shares the mm but not the rseq area */
+		if (clone_flags & CLONE_VM) {
+			rseq_clear(p);
+			vdso_cpu_invalidate(current->mm);
+		}
 		p->thread.ra = (unsigned long)ret_from_fork;
 	}
 	p->thread.sp = (unsigned long)childregs; /* kernel sp */
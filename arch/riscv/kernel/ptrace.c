@@ -5,6 +5,7 @@
 #include <linux/elf.h>
 #include <linux/regset.h>
 #include <linux/tracehook.h>
+#include <linux/context_tracking.h>
 #include <trace/events/syscalls.h>
 
 enum riscv_regset {
@@ -105,6 +106,9 @@ long arch_ptrace(struct task_struct *child, long request,
  * {handle,ret_from}_syscall. */
 void do_syscall_trace_enter(struct pt_regs *regs)
 {
+	/* Context tracking may have sent us down the slow path */
+	user_exit();
+
 	if (test_thread_flag(TIF_SYSCALL_TRACE)) {
 		if (tracehook_report_syscall_entry(regs))
 			syscall_set_nr(current, regs, -1);
@@ -123,6 +127,6 @@ void do_syscall_trace_exit(struct pt_regs *regs)
 
 #ifdef CONFIG_HAVE_SYSCALL_TRACEPOINTS
 	if (test_thread_flag(TIF_SYSCALL_TRACEPOINT))
-		trace_sys_exit(regs, regs->regs[0]);
+		trace_sys_exit(regs, regs->a0);
 #endif
 }
@@ -0,0 +1,174 @@
+/*
+ * Restartable sequences
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/sched.h>
+#include <linux/syscalls.h>
+#include <linux/uaccess.h>
+
+#include <asm/mmu_context.h>
+#include <asm/ptrace.h>
+#include <asm/rseq.h>
+
+static int rseq_update_cpu_id(struct task_struct *t)
+{
+	struct rseq __user *rseq = t->thread.rseq;
+	u32 cpu_id = raw_smp_processor_id();
+	int err = 0;
+
+	user_access_begin();
+	err |= unsafe_put_user(cpu_id, &rseq->cpu_id_start);
+	err |= unsafe_put_user(cpu_id, &rseq->cpu_id);
+	user_access_end();
+	return err;
+}
+
+/*
+ * If the task was interrupted inside its registered critical section,
+ * redirect it to the abort handler.  rseq_cs is cleared either way so
+ * the next check is a single load.
+ */
+static int rseq_ip_fixup(struct pt_regs *regs)
+{
+	struct task_struct *t = current;
+	struct rseq __user *rseq = t->thread.rseq;
+	struct rseq_cs __user *urseq_cs;
+	struct rseq_cs rseq_cs;
+	unsigned long ip = regs->sepc;
+	u64 ptr;
+	u32 sig;
+
+	if (get_user(ptr, &rseq->rseq_cs))
+		return -EFAULT;
+	if (!ptr)
+		return 0;
+	urseq_cs = (struct rseq_cs __user *)(unsigned long)ptr;
+	if (copy_from_user(&rseq_cs, urseq_cs, sizeof(rseq_cs)))
+		return -EFAULT;
+	if (rseq_cs.version || rseq_cs.flags ||
+	    rseq_cs.start_ip + rseq_cs.post_commit_offset < rseq_cs.start_ip)
+		return -EINVAL;
+
+	if (ip - rseq_cs.start_ip >= rseq_cs.post_commit_offset)
+		return put_user(0ULL, &rseq->rseq_cs);
+
+	/* The abort handler must be marked as such */
+	if (rseq_cs.abort_ip - rseq_cs.start_ip < rseq_cs.post_commit_offset)
+		return -EINVAL;
+	if (get_user(sig, (u32 __user *)(unsigned long)(rseq_cs.abort_ip - 4)))
+		return -EFAULT;
+	if (sig != t->thread.rseq_sig)
+		return -EINVAL;
+
+	if (put_user(0ULL, &rseq->rseq_cs))
+		return -EFAULT;
+	regs->sepc = rseq_cs.abort_ip;
+	return 0;
+}
+
+/*
+ * Called from do_notify_resume() after the task was switched out: abort
+ * any critical section it was in and tell it where it now runs.
+ */
+void rseq_handle_notify_resume(struct pt_regs *regs)
+{
+	struct task_struct *t = current;
+
+	if (!t->thread.rseq)
+		return;
+	if (unlikely(rseq_ip_fixup(regs) || rseq_update_cpu_id(t)))
+		force_sig(SIGSEGV, t);
+}
+
+/* Called from setup_rt_frame() so the frame records the abort address */
+int rseq_signal_deliver(struct pt_regs *regs)
+{
+	if (!current->thread.rseq)
+		return 0;
+	return rseq_ip_fixup(regs);
+}
+
+/*
+ * Record where a tp-relative registration put the area, for the vDSO
+ * getcpu.  Threads that disagree disable the fast path for the mm.
+ */
+static void rseq_publish_tp_offset(struct rseq __user *rseq)
+{
+	struct mm_struct *mm = current->mm;
+	struct vdso_mm_data *vdata = vdso_mm_data(mm);
+	long offset = (unsigned long)rseq - current_pt_regs()->tp;
+
+	down_write(&mm->mmap_sem);
+	switch (vdata->rseq_tp_state) {
+	case VDSO_RSEQ_TP_NONE:
+		WRITE_ONCE(vdata->rseq_tp_offset, offset);
+		smp_wmb();
+		WRITE_ONCE(vdata->rseq_tp_state, VDSO_RSEQ_TP_VALID);
+		break;
+	case VDSO_RSEQ_TP_VALID:
+		if (vdata->rseq_tp_offset != offset)
+			WRITE_ONCE(vdata->rseq_tp_state,
+				VDSO_RSEQ_TP_CONFLICT);
+		break;
+	}
+	up_write(&mm->mmap_sem);
+}
+
+/*
+ * sys_riscv_rseq - register or unregister the thread's struct rseq
+ * @rseq: area in userspace, aligned as struct rseq
+ * @rseq_len: sizeof(struct rseq)
+ * @flags: 0, RSEQ_FLAG_TP_RELATIVE or RSEQ_FLAG_UNREGISTER
+ * @sig: signature expected before every abort_ip
+ */
+SYSCALL_DEFINE4(riscv_rseq, struct rseq __user *, rseq, u32, rseq_len,
+	int, flags, u32, sig)
+{
+	struct task_struct *t = current;
+
+	if (flags & RSEQ_FLAG_UNREGISTER) {
+		if (flags & ~RSEQ_FLAG_UNREGISTER)
+			return -EINVAL;
+		if (t->thread.rseq != rseq)
+			return -EINVAL;
+		if (rseq_len != sizeof(*rseq))
+			return -EINVAL;
+		if (t->thread.rseq_sig != sig)
+			return -EPERM;
+		if (put_user((u32)RSEQ_CPU_ID_UNINITIALIZED, &rseq->cpu_id))
+			return -EFAULT;
+		rseq_clear(t);
+		return 0;
+	}
+
+	if (unlikely(flags & ~RSEQ_FLAG_TP_RELATIVE))
+		return -EINVAL;
+
+	if (t->thread.rseq) {
+		/* Already registered: only the same area is accepted */
+		if (t->thread.rseq != rseq || rseq_len != sizeof(*rseq))
+			return -EINVAL;
+		if (t->thread.rseq_sig != sig)
+			return -EPERM;
+		return -EBUSY;
+	}
+
+	if (!IS_ALIGNED((unsigned long)rseq, __alignof__(*rseq)) ||
+	    rseq_len != sizeof(*rseq))
+		return -EINVAL;
+	if (!access_ok(VERIFY_WRITE, rseq, rseq_len))
+		return -EFAULT;
+
+	if (flags & RSEQ_FLAG_TP_RELATIVE)
+		rseq_publish_tp_offset(rseq);
+
+	t->thread.rseq = rseq;
+	t->thread.rseq_sig = sig;
+	/* Fill in cpu_id before the syscall returns */
+	set_thread_flag(TIF_NOTIFY_RESUME);
+	return 0;
+}
@@ -7,6 +7,7 @@
 #include <linux/platform_device.h>
 #include <linux/spi/spi.h>
 #include <linux/spi/xilinx_spi.h>
+#include <linux/debugfs.h>
 
 #include <asm/setup.h>
 #include <asm/sections.h>
@@ -14,6 +15,7 @@
 #include <asm/smp.h>
 #include <asm/sbi.h>
 #include <asm/config-string.h>
+#include <asm/debug.h>
 
 static char __initdata command_line[COMMAND_LINE_SIZE];
 #ifdef CONFIG_CMDLINE_BOOL
@@ -23,6 +25,8 @@ static char __initdata builtin_cmdline[COMMAND_LINE_SIZE] = CONFIG_CMDLINE;
 unsigned long va_pa_offset;
 unsigned long pfn_base;
 
+struct dentry *riscv_debugfs_root;
+
 #ifdef CONFIG_BLK_DEV_INITRD
 static void __init setup_initrd(void)
 {
@@ -94,6 +98,7 @@ static void __init setup_bootmem(void)
 	BUG_ON((info.base & ~PMD_MASK) != 0);
 	BUG_ON((info.size & ~PMD_MASK) != 0);
 	pr_info("Available physical memory: %ldMB\n", info.size >> 20);
+	memblock_add_node(info.base, info.size, 0);
 
 	/* The kernel image is mapped at VA=PAGE_OFFSET and PA=info.base */
 	va_pa_offset = PAGE_OFFSET - info.base;
@@ -178,6 +183,15 @@ static int __init lowrisc_setup_devinit(void)
 
 device_initcall(lowrisc_setup_devinit);
 
+#ifdef CONFIG_DEBUG_FS
+static int __init riscv_debugfs_init(void)
+{
+	riscv_debugfs_root = debugfs_create_dir("riscv", NULL);
+	return riscv_debugfs_root ? 0 : -ENOMEM;
+}
+arch_initcall(riscv_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
+
 
 void __init setup_arch(char **cmdline_p)
 {
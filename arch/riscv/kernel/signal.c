@@ -6,6 +6,7 @@
 
 #include <asm/ucontext.h>
 #include <asm/vdso.h>
+#include <asm/rseq.h>
 #include <asm/switch_to.h>
 #include <asm/csr.h>
 
@@ -16,17 +17,36 @@ struct rt_sigframe {
 	struct ucontext uc;
 };
 
+/*
+ * The frame is read and written a field at a time inside a single
+ * user_access_begin()/user_access_end() window, rather than paying for
+ * an SR_PUM round trip on every access.  Live FP state is saved or
+ * discarded before the window is opened.
+ */
+
+/* Called with user access enabled, after fstate_discard() if UC_FP_STATE */
 static long restore_sigcontext(struct pt_regs *regs,
-	struct sigcontext __user *sc)
+	struct ucontext __user *uc, unsigned long flags)
 {
+	struct sigcontext __user *sc = &uc->uc_mcontext;
 	struct task_struct *task = current;
-	long err;
+	struct user_fpregs_struct *fstate = &task->thread.fstate;
+	unsigned long *gregs = (unsigned long *)regs;
+	unsigned long __user *sc_gregs = (unsigned long __user *)&sc->sc_regs;
+	long err = 0;
+	int i;
+
 	/* sc_regs is structured the same as the start of pt_regs */
-	err = __copy_from_user(regs, &sc->sc_regs, sizeof(sc->sc_regs));
-	err |= __copy_from_user(&task->thread.fstate, &sc->sc_fpregs,
-		sizeof(sc->sc_fpregs));
-	if (likely(!err))
-		fstate_restore(task, regs);
+	for (i = 0; i < sizeof(sc->sc_regs) / sizeof(long); i++)
+		err |= unsafe_get_user(gregs[i], &sc_gregs[i]);
+
+	/* Without UC_FP_STATE the live FP state is left as it is */
+	if (flags & UC_FP_STATE) {
+		for (i = 0; i < ARRAY_SIZE(fstate->f); i++)
+			err |= unsafe_get_user(fstate->f[i],
+				&sc->sc_fpregs.f[i]);
+		err |= unsafe_get_user(fstate->fcsr, &sc->sc_fpregs.fcsr);
+	}
 	return err;
 }
 
@@ -35,7 +55,10 @@ SYSCALL_DEFINE0(rt_sigreturn)
 	struct pt_regs *regs = current_pt_regs();
 	struct rt_sigframe __user *frame;
 	struct task_struct *task;
+	unsigned long flags;
 	sigset_t set;
+	long err = 0;
+	int i;
 
 	/* Always make any pending restarted system calls return -EINTR */
 	current->restart_block.fn = do_no_restart_syscall;
@@ -45,13 +68,28 @@ SYSCALL_DEFINE0(rt_sigreturn)
 	if (!access_ok(VERIFY_READ, frame, sizeof(*frame)))
 		goto badframe;
 
-	if (__copy_from_user(&set, &frame->uc.uc_sigmask, sizeof(set)))
+	if (__get_user(flags, &frame->uc.uc_flags))
+		goto badframe;
+	/*
+	 * Drop the live FP state before thread.fstate is overwritten, so a
+	 * context switch cannot save over the copy; it is loaded on next use.
+	 */
+	if (flags & UC_FP_STATE)
+		fstate_discard(current, regs);
+
+	user_access_begin();
+	for (i = 0; i < _NSIG_WORDS; i++)
+		err |= unsafe_get_user(set.sig[i],
+			&frame->uc.uc_sigmask.sig[i]);
+	err |= restore_sigcontext(regs, &frame->uc, flags);
+	user_access_end();
+	if (err)
 		goto badframe;
 
-	set_current_blocked(&set);
+	if (flags & UC_FP_STATE)
+		current->thread.fpu_used = 1;
 
-	if (restore_sigcontext(regs, &frame->uc.uc_mcontext))
-		goto badframe;
+	set_current_blocked(&set);
 
 	if (restore_altstack(&frame->uc.uc_stack))
 		goto badframe;
@@ -70,16 +108,34 @@ badframe:
 	return 0;
 }
 
-static long setup_sigcontext(struct sigcontext __user *sc,
+/* Called with user access enabled, after fstate_save() */
+static long setup_sigcontext(struct ucontext __user *uc,
 	struct pt_regs *regs)
 {
+	struct sigcontext __user *sc = &uc->uc_mcontext;
 	struct task_struct *task = current;
-	long err;
+	struct user_fpregs_struct *fstate = &task->thread.fstate;
+	unsigned long *gregs = (unsigned long *)regs;
+	unsigned long __user *sc_gregs = (unsigned long __user *)&sc->sc_regs;
+	unsigned long flags = 0;
+	long err = 0;
+	int i;
+
 	/* sc_regs is structured the same as the start of pt_regs */
-	err = __copy_to_user(&sc->sc_regs, regs, sizeof(sc->sc_regs));
-	fstate_save(task, regs);
-	err |= __copy_to_user(&sc->sc_fpregs, &task->thread.fstate,
-		sizeof(sc->sc_fpregs));
+	for (i = 0; i < sizeof(sc->sc_regs) / sizeof(long); i++)
+		err |= unsafe_put_user(gregs[i], &sc_gregs[i]);
+	/*
+	 * A task that has never used FP has nothing live to save, and its
+	 * thread.fstate is still the initial state: leave sc_fpregs alone.
+	 */
+	if (task->thread.fpu_used) {
+		for (i = 0; i < ARRAY_SIZE(fstate->f); i++)
+			err |= unsafe_put_user(fstate->f[i],
+				&sc->sc_fpregs.f[i]);
+		err |= unsafe_put_user(fstate->fcsr, &sc->sc_fpregs.fcsr);
+		flags |= UC_FP_STATE;
+	}
+	err |= unsafe_put_user(flags, &uc->uc_flags);
 	return err;
 }
 
@@ -112,19 +168,29 @@ static int setup_rt_frame(struct ksignal *ksig, sigset_t *set,
 {
 	struct rt_sigframe __user *frame;
 	long err = 0;
+	int i;
 
 	frame = get_sigframe(ksig, regs, sizeof(*frame));
 	if (!access_ok(VERIFY_WRITE, frame, sizeof(*frame)))
 		return -EFAULT;
 
+	/* Save the abort address if interrupted in a critical section */
+	if (rseq_signal_deliver(regs))
+		return -EFAULT;
+
 	err |= copy_siginfo_to_user(&frame->info, &ksig->info);
+	err |= __save_altstack(&frame->uc.uc_stack, regs->sp);
+	if (current->thread.fpu_used)
+		fstate_save(current, regs);
 
 	/* Create the ucontext. */
-	err |= __put_user(0, &frame->uc.uc_flags);
-	err |= __put_user(NULL, &frame->uc.uc_link);
-	err |= __save_altstack(&frame->uc.uc_stack, regs->sp);
-	err |= setup_sigcontext(&frame->uc.uc_mcontext, regs);
-	err |= __copy_to_user(&frame->uc.uc_sigmask, set, sizeof(*set));
+	user_access_begin();
+	err |= unsafe_put_user(NULL, &frame->uc.uc_link);
+	err |= setup_sigcontext(&frame->uc, regs);
+	for (i = 0; i < _NSIG_WORDS; i++)
+		err |= unsafe_put_user(set->sig[i],
+			&frame->uc.uc_sigmask.sig[i]);
+	user_access_end();
 	if (err)
 		return -EFAULT;
 
@@ -226,11 +292,14 @@ asmlinkage void do_notify_resume(struct pt_regs *regs,
 {
 	/* Handle pending signal delivery */
 	if (thread_info_flags & _TIF_SIGPENDING) {
+		/* The handler must not see a half-done vDSO sequence */
+		vdso_ras_fixup(regs);
 		do_signal(regs);
 	}
 
 	if (thread_info_flags & _TIF_NOTIFY_RESUME) {
 		clear_thread_flag(TIF_NOTIFY_RESUME);
 		tracehook_notify_resume(regs);
+		rseq_handle_notify_resume(regs);
 	}
 }
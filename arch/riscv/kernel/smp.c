@@ -1,4 +1,5 @@
 #include <linux/interrupt.h>
+#include <linux/irq_work.h>
 #include <linux/smp.h>
 #include <linux/sched.h>
 
@@ -14,6 +15,7 @@ static struct {
 enum ipi_message_type {
 	IPI_RESCHEDULE,
 	IPI_CALL_FUNC,
+	IPI_IRQ_WORK,
 	IPI_MAX
 };
 
@@ -36,6 +38,9 @@ irqreturn_t ipi_isr(int irq, void *dev_id)
 		if (ops & (1 << IPI_CALL_FUNC))
 			generic_smp_call_function_interrupt();
 
+		if (ops & (1 << IPI_IRQ_WORK))
+			irq_work_run();
+
 		BUG_ON((ops >> IPI_MAX) != 0);
 
 		mb();	/* Order data access and bit testing. */
@@ -83,3 +88,10 @@ void smp_send_reschedule(int cpu)
 {
 	send_ipi_message(cpumask_of(cpu), IPI_RESCHEDULE);
 }
+
+#ifdef CONFIG_IRQ_WORK
+void arch_irq_work_raise(void)
+{
+	send_ipi_message(cpumask_of(smp_processor_id()), IPI_IRQ_WORK);
+}
+#endif
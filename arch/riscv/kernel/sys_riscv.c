@@ -1,5 +1,6 @@
 #include <linux/syscalls.h>
 #include <asm/unistd.h>
+#include <asm/cacheflush.h>
 
 SYSCALL_DEFINE6(mmap, unsigned long, addr, unsigned long, len,
 	unsigned long, prot, unsigned long, flags,
@@ -24,6 +25,24 @@ SYSCALL_DEFINE6(mmap2, unsigned long, addr, unsigned long, len,
 }
 #endif /* !CONFIG_64BIT */
 
+/*
+ * Make code that userspace wrote to [start, end) safe to execute.  The
+ * range is advisory: fence.i acts on the whole instruction cache, and
+ * only the harts that have run this mm are involved.  No flags are
+ * defined yet.
+ */
+SYSCALL_DEFINE3(riscv_flush_icache, unsigned long, start,
+	unsigned long, end, unsigned long, flags)
+{
+	if (unlikely(flags))
+		return -EINVAL;
+	if (unlikely(start > end))
+		return -EINVAL;
+
+	flush_icache_mm(current->mm);
+	return 0;
+}
+
 #ifdef CONFIG_RV_SYSRISCV_ATOMIC
 SYSCALL_DEFINE4(sysriscv, unsigned long, cmd, unsigned long, arg1,
 	unsigned long, arg2, unsigned long, arg3)
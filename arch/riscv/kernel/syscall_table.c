@@ -2,6 +2,10 @@
 
 #include <asm/syscalls.h>
 
+/* Entry points that need the callee-saved registers in pt_regs */
+#define sys_clone		sys_clone_wrapper
+#define sys_rt_sigreturn	sys_rt_sigreturn_wrapper
+
 #undef __SYSCALL
 #define __SYSCALL(nr, call) [nr] = (call),
 
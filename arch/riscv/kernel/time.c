@@ -3,11 +3,18 @@
 #include <linux/interrupt.h>
 #include <linux/irq.h>
 #include <linux/delay.h>
+#include <linux/sched_clock.h>
+#include <linux/kernel_stat.h>
+#include <linux/math64.h>
+#include <linux/export.h>
 
 #include <asm/irq.h>
 #include <asm/csr.h>
 #include <asm/sbi.h>
 #include <asm/delay.h>
+#include <asm/trace_clock.h>
+#include <asm/uaccess.h>
+#include <asm/vdso.h>
 
 unsigned long timebase;
 
@@ -16,7 +23,7 @@ static DEFINE_PER_CPU(struct clock_event_device, clock_event);
 static int riscv_timer_set_next_event(unsigned long delta,
 	struct clock_event_device *evdev)
 {
-	sbi_set_timer(get_cycles() + delta);
+	sbi_set_timer(get_cycles64() + delta);
 	return 0;
 }
 
@@ -36,6 +43,10 @@ static irqreturn_t timer_interrupt(int irq, void *dev_id)
 {
 	int cpu = smp_processor_id();
 	struct clock_event_device *evdev = &per_cpu(clock_event, cpu);
+#ifdef CONFIG_VIRT_CPU_ACCOUNTING_NATIVE
+	/* Don't let user time pile up in thread_info between switches */
+	vtime_account_user(current);
+#endif
 	evdev->event_handler(evdev);
 	return IRQ_HANDLED;
 }
@@ -56,14 +67,156 @@ static struct clocksource riscv_clocksource = {
 	.name = "riscv_clocksource",
 	.rating = 300,
 	.read = riscv_rdtime,
-#ifdef CONFIG_64BITS
+#ifdef CONFIG_64BIT
 	.mask = CLOCKSOURCE_MASK(64),
 #else
 	.mask = CLOCKSOURCE_MASK(32),
-#endif /* CONFIG_64BITS */
+#endif /* CONFIG_64BIT */
 	.flags = CLOCK_SOURCE_IS_CONTINUOUS,
+	/* Set by riscv_vdso_time_probe() */
+	.archdata = { .vdso_direct = 0 },
 };
 
+/*
+ * The vDSO reads the user time CSR while the clocksource reads stime.
+ * Under the 1.9 privileged spec these are separate views of mtime: the
+ * user one may be offset, or trap if the SBI has not enabled it.  Let
+ * the vDSO read it only if it can be read here and agrees with stime.
+ */
+static void __init riscv_vdso_time_probe(void)
+{
+	unsigned long before, after, now, tmp;
+	int err = 0;
+
+	before = get_cycles();
+	__asm__ __volatile__ (
+		"1:\n"
+		"	rdtime %1\n"
+		"2:\n"
+		"	.section .fixup,\"ax\"\n"
+		"	.balign 4\n"
+		"3:\n"
+		"	li %0, %3\n"
+		"	jump 2b, %2\n"
+		"	.previous\n"
+		"	.section __ex_table,\"a\"\n"
+		"	.balign " SZPTR "\n"
+		"	" PTR " 1b, 3b\n"
+		"	.previous"
+		: "+r" (err), "=r" (now), "=r" (tmp)
+		: "i" (-EFAULT));
+	after = get_cycles();
+
+	if (err) {
+		pr_info("time CSR not readable, vDSO clocks use syscalls\n");
+		return;
+	}
+	if (now - before > after - before) {
+		pr_info("time CSR differs from stime, vDSO clocks use syscalls\n");
+		return;
+	}
+	riscv_clocksource.archdata.vdso_direct = 1;
+}
+
+/*
+ * A user rdtime or rdtimeh trapped after all, so the counter is not
+ * enabled for U-mode.  Complete the read from stime and move the vDSO
+ * to the syscall path from the next timekeeping update on.
+ */
+bool vdso_emulate_rdtime(struct pt_regs *regs, u32 insn)
+{
+	unsigned long *gpr = (unsigned long *)regs;
+	u64 now;
+	int rd;
+
+	/* csrrs rd, time[h], x0 */
+	if ((insn & 0xfffff07f) != 0xc0102073 &&
+	    (insn & 0xfffff07f) != 0xc8102073)
+		return false;
+
+	WRITE_ONCE(riscv_clocksource.archdata.vdso_direct, 0);
+
+	rd = (insn >> 7) & 0x1f;
+	now = get_cycles64();
+	/* pt_regs holds x1-x31 in order, after sepc */
+	if (rd)
+		gpr[rd] = (insn & 0x08000000) ? (unsigned long)(now >> 32) :
+						(unsigned long)now;
+	regs->sepc += 4;
+	return true;
+}
+
+static u64 notrace riscv_sched_clock(void)
+{
+	return get_cycles();
+}
+
+u64 notrace trace_clock_riscv_rdtime(void)
+{
+	return get_cycles();
+}
+
+#ifdef CONFIG_VIRT_CPU_ACCOUNTING_NATIVE
+/*
+ * entry.S stamps the time CSR on every user/kernel transition, adding
+ * the elapsed ticks to ac_utime on entry and to ac_stime on exit.
+ */
+static inline cputime_t cycles_to_cputime(unsigned long cycles)
+{
+	return mul_u64_u32_shr(cycles, riscv_clocksource.mult,
+			       riscv_clocksource.shift);
+}
+
+void vtime_account_user(struct task_struct *tsk)
+{
+	struct thread_info *ti = task_thread_info(tsk);
+	cputime_t delta;
+
+	if (ti->ac_utime) {
+		delta = cycles_to_cputime(ti->ac_utime);
+		account_user_time(tsk, delta, delta);
+		ti->ac_utime = 0;
+	}
+}
+
+void arch_vtime_task_switch(struct task_struct *prev)
+{
+	struct thread_info *pi = task_thread_info(prev);
+	struct thread_info *ni = task_thread_info(current);
+
+	ni->ac_stamp = pi->ac_stamp;
+	ni->ac_stime = ni->ac_utime = 0;
+}
+
+static cputime_t vtime_delta(struct task_struct *tsk)
+{
+	struct thread_info *ti = task_thread_info(tsk);
+	unsigned long now;
+	cputime_t delta;
+
+	WARN_ON_ONCE(!irqs_disabled());
+
+	now = get_cycles();
+	delta = cycles_to_cputime(ti->ac_stime + (now - ti->ac_stamp));
+	ti->ac_stime = 0;
+	ti->ac_stamp = now;
+	return delta;
+}
+
+void vtime_account_system(struct task_struct *tsk)
+{
+	cputime_t delta = vtime_delta(tsk);
+
+	account_system_time(tsk, 0, delta, delta);
+}
+EXPORT_SYMBOL_GPL(vtime_account_system);
+
+void vtime_account_idle(struct task_struct *tsk)
+{
+	account_idle_time(vtime_delta(tsk));
+}
+#endif /* CONFIG_VIRT_CPU_ACCOUNTING_NATIVE */
+
 void __init init_clockevent(void)
 {
 	int cpu = smp_processor_id();
@@ -79,7 +232,8 @@ void __init init_clockevent(void)
 		.set_state_shutdown = riscv_timer_set_shutdown,
 	};
 
-	clockevents_config_and_register(ce, sbi_timebase(), 100, 0x7fffffff);
+	/* The SBI takes an absolute 64-bit deadline */
+	clockevents_config_and_register(ce, sbi_timebase(), 100, ULONG_MAX);
 }
 
 void __init time_init(void)
@@ -88,7 +242,9 @@ void __init time_init(void)
 	lpj_fine = timebase;
 	do_div(lpj_fine, HZ);
 
+	riscv_vdso_time_probe();
 	clocksource_register_hz(&riscv_clocksource, timebase);
+	sched_clock_register(riscv_sched_clock, BITS_PER_LONG, timebase);
 	setup_irq(IRQ_TIMER, &timer_irq);
 	init_clockevent();
 }
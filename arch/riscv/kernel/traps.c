@@ -10,6 +10,8 @@
 #include <asm/processor.h>
 #include <asm/ptrace.h>
 #include <asm/csr.h>
+#include <asm/switch_to.h>
+#include <asm/vdso.h>
 
 int show_unhandled_signals = 1;
 
@@ -95,8 +97,72 @@ DO_ERROR_INFO(do_trap_unknown,
 	SIGILL, ILL_ILLTRP, "unknown exception");
 DO_ERROR_INFO(do_trap_insn_misaligned,
 	SIGBUS, BUS_ADRALN, "instruction address misaligned");
-DO_ERROR_INFO(do_trap_insn_illegal,
-	SIGILL, ILL_ILLOPC, "illegal instruction");
+
+/*
+ * Fetch the instruction at sepc a halfword at a time, since with RVC it
+ * need only be 2-byte aligned.  A compressed instruction is returned in
+ * the low 16 bits.
+ */
+static int get_user_insn(struct pt_regs *regs, u32 *insn)
+{
+	u16 __user *epc = (u16 __user *)regs->sepc;
+	u16 lo, hi;
+
+	if (get_user(lo, epc))
+		return -EFAULT;
+	if ((lo & 0x3) != 0x3) {
+		*insn = lo;
+		return 0;
+	}
+	if (get_user(hi, epc + 1))
+		return -EFAULT;
+	*insn = ((u32)hi << 16) | lo;
+	return 0;
+}
+
+/* Would the instruction trap only because FS is off? */
+static bool insn_uses_fp(u32 insn)
+{
+	if ((insn & 0x3) != 0x3) {
+		/* c.fld[sp], c.fsd[sp], and c.flw[sp], c.fsw[sp] on RV32 */
+		return ((insn & 0x3) == 0x0 || (insn & 0x3) == 0x2) &&
+			(insn & 0x2000);
+	}
+
+	switch (insn & 0x7f) {
+	case 0x07:	/* LOAD-FP */
+	case 0x27:	/* STORE-FP */
+	case 0x43:	/* FMADD */
+	case 0x47:	/* FMSUB */
+	case 0x4b:	/* FNMSUB */
+	case 0x4f:	/* FNMADD */
+	case 0x53:	/* OP-FP */
+		return true;
+	case 0x73:	/* SYSTEM: fflags, frm and fcsr */
+		return ((insn >> 12) & 0x7) != 0 &&
+			(insn >> 20) >= 0x001 && (insn >> 20) <= 0x003;
+	}
+	return false;
+}
+
+asmlinkage void do_trap_insn_illegal(struct pt_regs *regs)
+{
+	u32 insn;
+
+	if (user_mode(regs) && !get_user_insn(regs, &insn)) {
+		if (vdso_emulate_rdtime(regs, insn))
+			return;
+		/* First FP instruction since the task was switched in */
+		if (current->thread.fpu_lazy && insn_uses_fp(insn)) {
+			preempt_disable();
+			fstate_load(current, regs);
+			preempt_enable();
+			return;
+		}
+	}
+	do_trap_error(regs, SIGILL, ILL_ILLOPC, regs->sepc,
+		"Oops - illegal instruction");
+}
 
 asmlinkage void do_trap_break(struct pt_regs *regs)
 {
@@ -2,7 +2,10 @@
 #include <linux/slab.h>
 #include <linux/binfmts.h>
 #include <linux/err.h>
+#include <linux/hrtimer.h>
+#include <linux/timekeeper_internal.h>
 
+#include <asm/ptrace.h>
 #include <asm/vdso.h>
 
 extern char vdso_start[], vdso_end[];
@@ -10,6 +13,24 @@ extern char vdso_start[], vdso_end[];
 static unsigned int vdso_pages;
 static struct page **vdso_pagelist;
 
+static int vdso_cpu_fault(const struct vm_special_mapping *sm,
+	struct vm_area_struct *vma, struct vm_fault *vmf)
+{
+	struct page *page = vma->vm_mm->context.vdso_cpu_page;
+
+	if (vmf->pgoff != 0)
+		return VM_FAULT_SIGBUS;
+	get_page(page);
+	vmf->page = page;
+	return 0;
+}
+
+/* The getcpu page differs per mm, so it is looked up at fault time */
+static const struct vm_special_mapping vdso_cpu_mapping = {
+	.name	= "[vvar]",
+	.fault	= vdso_cpu_fault,
+};
+
 /*
  * The vDSO data page.
  */
@@ -30,13 +51,17 @@ static int __init vdso_init(void)
 		return -ENOMEM;
 	}
 
+	/* The data page precedes the text so the vDSO can find it */
+	vdso_pagelist[0] = virt_to_page(vdso_data);
 	for (i = 0; i < vdso_pages; i++) {
 		struct page *pg;
 		pg = virt_to_page(vdso_start + (i << PAGE_SHIFT));
 		ClearPageReserved(pg);
-		vdso_pagelist[i] = pg;
+		vdso_pagelist[i + 1] = pg;
 	}
-	vdso_pagelist[i] = virt_to_page(vdso_data);
+
+	for_each_possible_cpu(i)
+		vdso_data->cpu_node[i] = cpu_to_node(i);
 
 	return 0;
 }
@@ -46,10 +71,12 @@ int arch_setup_additional_pages(struct linux_binprm *bprm,
 	int uses_interp)
 {
 	struct mm_struct *mm = current->mm;
+	struct vm_area_struct *vma;
 	unsigned long vdso_base, vdso_len;
 	int ret;
 
-	vdso_len = (vdso_pages + 1) << PAGE_SHIFT;
+	/* getcpu page, data page, then the vDSO text */
+	vdso_len = (vdso_pages + 2) << PAGE_SHIFT;
 
 	down_write(&mm->mmap_sem);
 	vdso_base = get_unmapped_area(NULL, 0, vdso_len, 0, 0);
@@ -63,15 +90,29 @@ int arch_setup_additional_pages(struct linux_binprm *bprm,
 	 * install_special_mapping or the perf counter mmap tracking code
 	 * will fail to recognise it as a vDSO (since arch_vma_name fails).
 	 */
-	mm->context.vdso = (void *)vdso_base;
+	mm->context.vdso = (void *)vdso_base + 2 * PAGE_SIZE;
+
+	vma = _install_special_mapping(mm, vdso_base, PAGE_SIZE,
+		(VM_READ | VM_MAYREAD), &vdso_cpu_mapping);
+	if (unlikely(IS_ERR(vma))) {
+		ret = PTR_ERR(vma);
+		goto fail;
+	}
 
-	ret = install_special_mapping(mm, vdso_base, vdso_len,
+	ret = install_special_mapping(mm, vdso_base + PAGE_SIZE, PAGE_SIZE,
+		(VM_READ | VM_MAYREAD), vdso_pagelist);
+	if (unlikely(ret))
+		goto fail;
+
+	ret = install_special_mapping(mm, vdso_base + 2 * PAGE_SIZE,
+		vdso_len - 2 * PAGE_SIZE,
 		(VM_READ | VM_EXEC | VM_MAYREAD | VM_MAYWRITE | VM_MAYEXEC),
-		vdso_pagelist);
+		vdso_pagelist + 1);
+	if (likely(!ret))
+		goto end;
 
-	if (unlikely(ret)) {
-		mm->context.vdso = NULL;
-	}
+fail:
+	mm->context.vdso = NULL;
 
 end:
 	up_write(&mm->mmap_sem);
@@ -83,9 +124,100 @@ const char *arch_vma_name(struct vm_area_struct *vma)
 	if (vma->vm_mm && (vma->vm_start == (long)vma->vm_mm->context.vdso)) {
 		return "[vdso]";
 	}
+	if (vma->vm_mm && vma->vm_mm->context.vdso &&
+	    (vma->vm_start == (long)vma->vm_mm->context.vdso - PAGE_SIZE)) {
+		return "[vvar]";
+	}
 	return NULL;
 }
 
+#ifndef CONFIG_RV_ATOMIC
+#define VDSO_RAS(name)	{ __vdso_##name##_ras_start, __vdso_##name##_ras_end }
+
+extern const char __vdso_cmpxchg32_ras_start[], __vdso_cmpxchg32_ras_end[];
+#ifdef CONFIG_64BIT
+extern const char __vdso_cmpxchg64_ras_start[], __vdso_cmpxchg64_ras_end[];
+#endif
+
+/* Offsets of the restartable sequences within the vDSO text */
+static const struct {
+	const char *start;
+	const char *end;
+} vdso_ras[] = {
+	VDSO_RAS(cmpxchg32),
+#ifdef CONFIG_64BIT
+	VDSO_RAS(cmpxchg64),
+#endif
+};
+
+/*
+ * Restart a vDSO atomic sequence that was interrupted before its final
+ * store.  Called on the way back to userspace whenever other code may
+ * have run in between: before rescheduling, before signal delivery and
+ * on page faults, which may sleep.
+ */
+void vdso_ras_fixup(struct pt_regs *regs)
+{
+	struct mm_struct *mm = current->mm;
+	unsigned long base, pc;
+	unsigned int i;
+
+	if (unlikely(!mm || !mm->context.vdso || !user_mode(regs)))
+		return;
+
+	base = (unsigned long)mm->context.vdso;
+	pc = regs->sepc - base;
+	for (i = 0; i < ARRAY_SIZE(vdso_ras); i++) {
+		unsigned long start = (unsigned long)vdso_ras[i].start;
+		unsigned long end = (unsigned long)vdso_ras[i].end;
+
+		if (pc - start < end - start) {
+			regs->sepc = base + start;
+			return;
+		}
+	}
+}
+#endif /* !CONFIG_RV_ATOMIC */
+
+/*
+ * Publish the timekeeper state to the vDSO.  Readers retry while
+ * seq_count is odd or changes underneath them.
+ */
+void update_vsyscall(struct timekeeper *tk)
+{
+	struct timespec xtime_coarse;
+	u32 use_syscall = (tk->tkr_mono.clock->archdata.vdso_direct == 0);
+
+	++vdso_data->seq_count;
+	smp_wmb();
+
+	xtime_coarse = __current_kernel_time();
+	vdso_data->use_syscall		= use_syscall;
+	vdso_data->xtime_coarse_sec	= xtime_coarse.tv_sec;
+	vdso_data->xtime_coarse_nsec	= xtime_coarse.tv_nsec;
+	vdso_data->wtm_clock_sec	= tk->wall_to_monotonic.tv_sec;
+	vdso_data->wtm_clock_nsec	= tk->wall_to_monotonic.tv_nsec;
+	vdso_data->hrtimer_res		= hrtimer_resolution;
+
+	if (!use_syscall) {
+		vdso_data->cs_cycle_last	= tk->tkr_mono.cycle_last;
+		vdso_data->cs_mask		= tk->tkr_mono.mask;
+		vdso_data->cs_mult		= tk->tkr_mono.mult;
+		vdso_data->cs_shift		= tk->tkr_mono.shift;
+		vdso_data->xtime_clock_sec	= tk->xtime_sec;
+		vdso_data->xtime_clock_nsec	= tk->tkr_mono.xtime_nsec;
+	}
+
+	smp_wmb();
+	++vdso_data->seq_count;
+}
+
+void update_vsyscall_tz(void)
+{
+	vdso_data->tz_minuteswest	= sys_tz.tz_minuteswest;
+	vdso_data->tz_dsttime		= sys_tz.tz_dsttime;
+}
+
 /*
  * Function stubs to prevent linker errors when AT_SYSINFO_EHDR is defined
  */
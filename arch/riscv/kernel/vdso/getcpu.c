@@ -0,0 +1,55 @@
+/*
+ * Userspace implementation of getcpu.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/compiler.h>
+#include <linux/getcpu.h>
+#include <asm/barrier.h>
+#include <asm/unistd.h>
+#include <asm/vdso.h>
+#include <uapi/asm/rseq.h>
+
+#include "vdso.h"
+
+/* Provided by the linker script */
+extern const struct vdso_data _vdso_data __attribute__((visibility("hidden")));
+extern const struct vdso_mm_data _vdso_cpu __attribute__((visibility("hidden")));
+
+/* The CPU from the calling thread's rseq area, if it has one */
+static notrace u32 vdso_rseq_cpu(const struct vdso_mm_data *vm)
+{
+	const struct rseq *rs;
+	unsigned long tp;
+
+	if (READ_ONCE(vm->rseq_tp_state) != VDSO_RSEQ_TP_VALID)
+		return VDSO_CPU_UNKNOWN;
+	smp_rmb();
+	__asm__ ("mv %0, tp" : "=r" (tp));
+	rs = (const struct rseq *)(tp + READ_ONCE(vm->rseq_tp_offset));
+	return READ_ONCE(rs->cpu_id);
+}
+
+notrace int __vdso_getcpu(unsigned *cpu, unsigned *node,
+	struct getcpu_cache *unused)
+{
+	const struct vdso_mm_data *vm = &_vdso_cpu;
+	u32 c = READ_ONCE(vm->cpu);
+
+	/* Threads share the page, so each needs its own rseq area */
+	if (c == VDSO_CPU_UNKNOWN)
+		c = vdso_rseq_cpu(vm);
+
+	/* Also rejects RSEQ_CPU_ID_UNINITIALIZED */
+	if (unlikely(c >= NR_CPUS))
+		return vdso_fallback(__NR_getcpu, (long)cpu, (long)node);
+
+	if (cpu)
+		*cpu = c;
+	if (node)
+		*node = _vdso_data.cpu_node[c];
+	return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef _RISCV_KERNEL_VDSO_VDSO_H
+#define _RISCV_KERNEL_VDSO_VDSO_H
+
+#include <linux/compiler.h>
+
+/* Enter the kernel when the fast path cannot answer */
+static inline notrace long vdso_fallback(long nr, long arg0, long arg1)
+{
+	register long a0 asm("a0") = arg0;
+	register long a1 asm("a1") = arg1;
+	register long a7 asm("a7") = nr;
+
+	__asm__ __volatile__ (
+		"scall"
+		: "+r" (a0)
+		: "r" (a1), "r" (a7)
+		: "memory");
+	return a0;
+}
+
+#endif /* _RISCV_KERNEL_VDSO_VDSO_H */
@@ -0,0 +1,206 @@
+/*
+ * Userspace implementations of clock_gettime, gettimeofday and
+ * clock_getres, reading the time CSR directly.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/compiler.h>
+#include <linux/hrtimer.h>
+#include <linux/math64.h>
+#include <linux/time.h>
+#include <asm/barrier.h>
+#include <asm/unistd.h>
+#include <asm/vdso.h>
+
+#include "vdso.h"
+
+/* Provided by the linker script: the data page just below the text */
+extern const struct vdso_data _vdso_data __attribute__((visibility("hidden")));
+
+static notrace u64 vdso_rdtime(void)
+{
+#ifdef __riscv64
+	u64 n;
+	__asm__ __volatile__ (
+		"rdtime %0"
+		: "=r" (n));
+	return n;
+#else
+	u32 lo, hi, tmp;
+	__asm__ __volatile__ (
+		"1:\n"
+		"rdtimeh %0\n"
+		"rdtime %1\n"
+		"rdtimeh %2\n"
+		"bne %0, %2, 1b"
+		: "=&r" (hi), "=&r" (lo), "=&r" (tmp));
+	return ((u64)hi << 32) | lo;
+#endif
+}
+
+static notrace u32 vdso_read_begin(const struct vdso_data *vd)
+{
+	u32 seq;
+
+	while ((seq = READ_ONCE(vd->seq_count)) & 1)
+		barrier();
+	smp_rmb();
+	return seq;
+}
+
+static notrace int vdso_read_retry(const struct vdso_data *vd, u32 start)
+{
+	smp_rmb();
+	return READ_ONCE(vd->seq_count) != start;
+}
+
+/* Nanoseconds since xtime_clock_sec, not yet normalised */
+static notrace u64 vdso_get_ns(const struct vdso_data *vd)
+{
+	u64 cycles = (vdso_rdtime() - vd->cs_cycle_last) & vd->cs_mask;
+
+	return (vd->xtime_clock_nsec + cycles * vd->cs_mult) >> vd->cs_shift;
+}
+
+static notrace void vdso_set_ts(struct timespec *ts, u64 sec, u64 ns)
+{
+	ts->tv_sec = sec + __iter_div_u64_rem(ns, NSEC_PER_SEC, &ns);
+	ts->tv_nsec = ns;
+}
+
+static notrace int do_realtime(const struct vdso_data *vd, struct timespec *ts)
+{
+	u32 seq;
+	u64 sec, ns;
+
+	do {
+		seq = vdso_read_begin(vd);
+		if (vd->use_syscall)
+			return -1;
+		sec = vd->xtime_clock_sec;
+		ns = vdso_get_ns(vd);
+	} while (unlikely(vdso_read_retry(vd, seq)));
+
+	vdso_set_ts(ts, sec, ns);
+	return 0;
+}
+
+static notrace int do_monotonic(const struct vdso_data *vd, struct timespec *ts)
+{
+	u32 seq;
+	u64 sec, ns;
+
+	do {
+		seq = vdso_read_begin(vd);
+		if (vd->use_syscall)
+			return -1;
+		sec = vd->xtime_clock_sec + vd->wtm_clock_sec;
+		ns = vdso_get_ns(vd) + vd->wtm_clock_nsec;
+	} while (unlikely(vdso_read_retry(vd, seq)));
+
+	vdso_set_ts(ts, sec, ns);
+	return 0;
+}
+
+static notrace void do_realtime_coarse(const struct vdso_data *vd,
+	struct timespec *ts)
+{
+	u32 seq;
+	u64 sec, ns;
+
+	do {
+		seq = vdso_read_begin(vd);
+		sec = vd->xtime_coarse_sec;
+		ns = vd->xtime_coarse_nsec;
+	} while (unlikely(vdso_read_retry(vd, seq)));
+
+	vdso_set_ts(ts, sec, ns);
+}
+
+static notrace void do_monotonic_coarse(const struct vdso_data *vd,
+	struct timespec *ts)
+{
+	u32 seq;
+	u64 sec, ns;
+
+	do {
+		seq = vdso_read_begin(vd);
+		sec = vd->xtime_coarse_sec + vd->wtm_clock_sec;
+		ns = vd->xtime_coarse_nsec + vd->wtm_clock_nsec;
+	} while (unlikely(vdso_read_retry(vd, seq)));
+
+	vdso_set_ts(ts, sec, ns);
+}
+
+notrace int __vdso_clock_gettime(clockid_t clock, struct timespec *ts)
+{
+	const struct vdso_data *vd = &_vdso_data;
+
+	switch (clock) {
+	case CLOCK_REALTIME:
+		if (do_realtime(vd, ts))
+			break;
+		return 0;
+	case CLOCK_MONOTONIC:
+		if (do_monotonic(vd, ts))
+			break;
+		return 0;
+	case CLOCK_REALTIME_COARSE:
+		do_realtime_coarse(vd, ts);
+		return 0;
+	case CLOCK_MONOTONIC_COARSE:
+		do_monotonic_coarse(vd, ts);
+		return 0;
+	}
+
+	return vdso_fallback(__NR_clock_gettime, clock, (long)ts);
+}
+
+notrace int __vdso_gettimeofday(struct timeval *tv, struct timezone *tz)
+{
+	const struct vdso_data *vd = &_vdso_data;
+
+	if (likely(tv != NULL)) {
+		struct timespec ts;
+
+		if (do_realtime(vd, &ts))
+			return vdso_fallback(__NR_gettimeofday, (long)tv, (long)tz);
+		tv->tv_sec = ts.tv_sec;
+		tv->tv_usec = ts.tv_nsec / NSEC_PER_USEC;
+	}
+
+	if (unlikely(tz != NULL)) {
+		tz->tz_minuteswest = vd->tz_minuteswest;
+		tz->tz_dsttime = vd->tz_dsttime;
+	}
+
+	return 0;
+}
+
+notrace int __vdso_clock_getres(clockid_t clock, struct timespec *res)
+{
+	const struct vdso_data *vd = &_vdso_data;
+	long ns;
+
+	switch (clock) {
+	case CLOCK_REALTIME:
+	case CLOCK_MONOTONIC:
+		ns = vd->hrtimer_res;
+		break;
+	case CLOCK_REALTIME_COARSE:
+	case CLOCK_MONOTONIC_COARSE:
+		ns = LOW_RES_NSEC;
+		break;
+	default:
+		return vdso_fallback(__NR_clock_getres, clock, (long)res);
+	}
+
+	if (likely(res != NULL)) {
+		res->tv_sec = 0;
+		res->tv_nsec = ns;
+	}
+	return 0;
+}
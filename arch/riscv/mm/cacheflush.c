@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/mm.h>
+#include <linux/sched.h>
+#include <linux/smp.h>
+
+#include <asm/cacheflush.h>
+#include <asm/sbi.h>
+
+/*
+ * Make stores to the instruction stream of @mm visible to every hart
+ * that may fetch from it.  Harts running the mm right now, which are
+ * those in mm_cpumask(), get a remote fence.i.  Every other hart is
+ * marked in icache_stale_mask and flushes in switch_mm() before it next
+ * runs the mm, so an mm that is only running here costs a local
+ * fence.i whatever it did in the past.
+ */
+void flush_icache_mm(struct mm_struct *mm)
+{
+	unsigned int cpu;
+	cpumask_t others;
+
+	cpu = get_cpu();
+
+	cpumask_setall(&mm->context.icache_stale_mask);
+	cpumask_clear_cpu(cpu, &mm->context.icache_stale_mask);
+	local_flush_icache_all();
+
+	/* Pairs with the barrier in flush_icache_deferred() */
+	smp_mb();
+	cpumask_andnot(&others, mm_cpumask(mm), cpumask_of(cpu));
+	if (!cpumask_empty(&others))
+		sbi_remote_fence_i((unsigned long)cpumask_bits(&others));
+
+	put_cpu();
+}
@@ -4,10 +4,20 @@
 #include <linux/perf_event.h>
 #include <linux/signal.h>
 #include <linux/uaccess.h>
+#include <linux/debugfs.h>
 
 #include <asm/pgalloc.h>
 #include <asm/ptrace.h>
 #include <asm/uaccess.h>
+#include <asm/debug.h>
+#include <asm/vdso.h>
+
+/*
+ * Number of kernel faults taken on the vmalloc area.  These should be
+ * rare now that paging_init() preallocates the shared tables; any that
+ * remain are spurious or genuine bad accesses.
+ */
+static atomic_t vmalloc_faults = ATOMIC_INIT(0);
 
 /*
  * This routine handles page faults.  It determines the address and the
@@ -51,8 +61,11 @@ asmlinkage void do_page_fault(struct pt_regs *regs)
 	if (unlikely(faulthandler_disabled() || !mm))
 		goto no_context;
 
-	if (user_mode(regs))
+	if (user_mode(regs)) {
 		flags |= FAULT_FLAG_USER;
+		/* Handling the fault may sleep */
+		vdso_ras_fixup(regs);
+	}
 
 	perf_sw_event(PERF_COUNT_SW_PAGE_FAULTS, 1, regs, addr);
 
@@ -205,9 +218,11 @@ vmalloc_fault:
 		pte_t *pte_k;
 		int index;
 
-	        if (user_mode(regs))
+		if (user_mode(regs))
 			goto bad_area;
 
+		atomic_inc(&vmalloc_faults);
+
 		/*
 		 * Synchronize this task's top level page-table
 		 * with the 'reference' page table.
@@ -237,6 +252,10 @@ vmalloc_fault:
 			goto no_context;
 		set_pmd(pmd, *pmd_k);
 
+		/* Huge ioremap mappings have no PTE level to check */
+		if (pmd_leaf(*pmd_k))
+			return;
+
 		/* Make sure the actual PTE exists as well to
 		 * catch kernel vmalloc-area accesses to non-mapped
 		 * addresses. If we don't do this, this will just
@@ -248,3 +267,16 @@ vmalloc_fault:
 		return;
 	}
 }
+
+#ifdef CONFIG_DEBUG_FS
+static int __init vmalloc_fault_debugfs_init(void)
+{
+	if (!riscv_debugfs_root)
+		return -ENODEV;
+	if (!debugfs_create_atomic_t("vmalloc_faults", S_IRUGO,
+			riscv_debugfs_root, &vmalloc_faults))
+		return -ENOMEM;
+	return 0;
+}
+device_initcall(vmalloc_fault_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
@@ -9,6 +9,7 @@
 #include <asm/sections.h>
 #include <asm/pgtable.h>
 #include <asm/io.h>
+#include <asm/pgalloc.h>
 
 #ifdef CONFIG_NUMA
 static void __init zone_sizes_init(void)
@@ -38,7 +39,6 @@ static void __init zone_sizes_init(void)
 	unsigned long zones_size[MAX_NR_ZONES];
 
 	memset(zones_size, 0, sizeof(zones_size));
-	memblock_add_node(PFN_PHYS(pfn_base), PFN_PHYS(max_mapnr), 0);
 	zones_size[ZONE_NORMAL] = pfn_base + max_mapnr;
 	free_area_init_nodes(zones_size);
 }
@@ -49,20 +49,105 @@ void setup_zero_page(void)
 	memset((void *)empty_zero_page, 0, PAGE_SIZE);
 }
 
+/*
+ * Allocate the page tables one level below the PGD for the entire
+ * vmalloc area up front.  Every PGD copies these entries at fork, so
+ * later vmalloc mappings become visible to all address spaces without
+ * having to synchronise them lazily in vmalloc_fault.
+ */
+static void __init preallocate_vmalloc_tables(void)
+{
+	unsigned long addr;
+	pud_t *pud;
+	void *table;
+
+#ifndef __PAGETABLE_PMD_FOLDED
+	for (addr = VMALLOC_START & PGDIR_MASK;
+	     addr - 1 < VMALLOC_END; addr += PGDIR_SIZE) {
+		pud = pud_offset(pgd_offset_k(addr), addr);
+		if (!pud_none(*pud))
+			continue;
+		table = memblock_virt_alloc(PAGE_SIZE, PAGE_SIZE);
+		pud_populate(&init_mm, pud, table);
+	}
+#else
+	pmd_t *pmd;
+
+	for (addr = VMALLOC_START & PMD_MASK;
+	     addr - 1 < VMALLOC_END; addr += PMD_SIZE) {
+		pud = pud_offset(pgd_offset_k(addr), addr);
+		pmd = pmd_offset(pud, addr);
+		if (!pmd_none(*pmd))
+			continue;
+		table = memblock_virt_alloc(PAGE_SIZE, PAGE_SIZE);
+		pmd_populate_kernel(&init_mm, pmd, table);
+	}
+#endif /* __PAGETABLE_PMD_FOLDED */
+}
+
 void __init paging_init(void)
 {
 	init_mm.pgd = (pgd_t *)pfn_to_virt(csr_read(sptbr));
 
+	preallocate_vmalloc_tables();
 	setup_zero_page();
 	local_flush_tlb_all();
+#ifdef CONFIG_SPARSEMEM
+	sparse_memory_present_with_active_regions(MAX_NUMNODES);
+	sparse_init();
+#endif /* CONFIG_SPARSEMEM */
 	zone_sizes_init();
 }
 
+#ifdef CONFIG_SPARSEMEM_VMEMMAP
+/*
+ * Back the virtual memory map with megapages.  Each section's struct
+ * pages fill exactly one PMD entry, so no PTE-level tables are needed.
+ */
+int __meminit vmemmap_populate(unsigned long start, unsigned long end,
+	int node)
+{
+	unsigned long addr, next;
+	pgd_t *pgd;
+	pud_t *pud;
+	pmd_t *pmd;
+
+	for (addr = start; addr < end; addr = next) {
+		next = pmd_addr_end(addr, end);
+
+		pgd = vmemmap_pgd_populate(addr, node);
+		if (!pgd)
+			return -ENOMEM;
+		pud = vmemmap_pud_populate(pgd, addr, node);
+		if (!pud)
+			return -ENOMEM;
+
+		pmd = pmd_offset(pud, addr);
+		if (pmd_none(*pmd)) {
+			void *p = vmemmap_alloc_block_buf(PMD_SIZE, node);
+			if (!p)
+				return -ENOMEM;
+			set_pmd(pmd, pfn_pmd(virt_to_pfn(p), PAGE_KERNEL));
+		} else {
+			vmemmap_verify((pte_t *)pmd, node, addr, next);
+		}
+	}
+	return 0;
+}
+
+void vmemmap_free(unsigned long start, unsigned long end)
+{
+}
+#endif /* CONFIG_SPARSEMEM_VMEMMAP */
+
 void __init mem_init(void)
 {
 #ifdef CONFIG_FLATMEM
 	BUG_ON(!mem_map);
 #endif /* CONFIG_FLATMEM */
+#ifdef CONFIG_SPARSEMEM_VMEMMAP
+	BUILD_BUG_ON(sizeof(struct page) > (1 << STRUCT_PAGE_MAX_SHIFT));
+#endif /* CONFIG_SPARSEMEM_VMEMMAP */
 
 	high_memory = (void *)(__va(PFN_PHYS(max_low_pfn)));
 	free_all_bootmem();
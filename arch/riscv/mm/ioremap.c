@@ -4,6 +4,8 @@
 #include <linux/io.h>
 
 #include <asm/pgtable.h>
+#include <asm/pgalloc.h>
+#include <asm/tlbflush.h>
 
 /*
  * Remap an arbitrary physical address space into the kernel virtual
@@ -79,3 +81,73 @@ void iounmap(void __iomem *addr)
 }
 EXPORT_SYMBOL(iounmap);
 
+
+#ifdef CONFIG_HAVE_ARCH_HUGE_VMAP
+/*
+ * Gigapage mappings are never attempted: the vmalloc area is smaller
+ * than PUD_SIZE, and PGD entries are copied into each address space at
+ * fork rather than shared, so a new leaf would not propagate.
+ */
+int __init arch_ioremap_pud_supported(void)
+{
+	return 0;
+}
+
+/*
+ * The PMD page covering the vmalloc area is shared by every address
+ * space (see paging_init), so megapage entries installed in init_mm
+ * are immediately visible everywhere.
+ */
+int __init arch_ioremap_pmd_supported(void)
+{
+	return 1;
+}
+
+int pud_set_huge(pud_t *pud, phys_addr_t addr, pgprot_t prot)
+{
+	/* Never replace a table that may still be referenced */
+	if (pud_present(*pud) && !pud_leaf(*pud))
+		return 0;
+	set_pud(pud, pfn_pud(addr >> PAGE_SHIFT, prot));
+	return 1;
+}
+
+int pud_clear_huge(pud_t *pud)
+{
+	if (!pud_leaf(*pud))
+		return 0;
+	pud_clear(pud);
+	return 1;
+}
+
+int pmd_set_huge(pmd_t *pmd, phys_addr_t addr, pgprot_t prot)
+{
+	if (pmd_present(*pmd) && !pmd_leaf(*pmd)) {
+		pte_t *pte = (pte_t *)pmd_page_vaddr(*pmd);
+		int i;
+
+		/*
+		 * vunmap() leaves empty PTE pages behind.  Reclaim such a
+		 * page rather than leak it, but fall back to small pages
+		 * if anything is still mapped through it.
+		 */
+		for (i = 0; i < PTRS_PER_PTE; i++) {
+			if (!pte_none(pte[i]))
+				return 0;
+		}
+		pmd_clear(pmd);
+		flush_tlb_all();
+		pte_free_kernel(&init_mm, pte);
+	}
+	set_pmd(pmd, pfn_pmd(addr >> PAGE_SHIFT, prot));
+	return 1;
+}
+
+int pmd_clear_huge(pmd_t *pmd)
+{
+	if (!pmd_leaf(*pmd))
+		return 0;
+	pmd_clear(pmd);
+	return 1;
+}
+#endif /* CONFIG_HAVE_ARCH_HUGE_VMAP */
@@ -0,0 +1,66 @@
+#include <linux/mm.h>
+#include <linux/percpu.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/quicklist.h>
+
+#include <asm/pgalloc.h>
+#include <asm/debug.h>
+
+DEFINE_PER_CPU(unsigned long, pgt_cache_allocs);
+static DEFINE_PER_CPU(unsigned long, pgt_cache_misses);
+
+/*
+ * The constructor runs only when the quicklist is empty and a fresh
+ * zeroed page had to be taken from the page allocator.
+ */
+void pgd_ctor(void *pgd)
+{
+	this_cpu_inc(pgt_cache_misses);
+	/* Copy kernel mappings */
+	memcpy((pgd_t *)pgd + USER_PTRS_PER_PGD,
+		init_mm.pgd + USER_PTRS_PER_PGD,
+		(PTRS_PER_PGD - USER_PTRS_PER_PGD) * sizeof(pgd_t));
+}
+
+#ifdef CONFIG_DEBUG_FS
+static int pgt_cache_show(struct seq_file *m, void *v)
+{
+	int cpu;
+
+	seq_puts(m, "cpu      allocs        hits      misses  pgd\n");
+	for_each_online_cpu(cpu) {
+		unsigned long allocs = per_cpu(pgt_cache_allocs, cpu);
+		unsigned long misses = per_cpu(pgt_cache_misses, cpu);
+		struct quicklist *q = per_cpu(quicklist, cpu);
+
+		seq_printf(m, "%3d %11lu %11lu %11lu %4d\n", cpu,
+			allocs, allocs - misses, misses,
+			q[QUICK_PGD].nr_pages);
+	}
+	return 0;
+}
+
+static int pgt_cache_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, pgt_cache_show, NULL);
+}
+
+static const struct file_operations pgt_cache_fops = {
+	.open		= pgt_cache_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init pgt_cache_debugfs_init(void)
+{
+	if (!riscv_debugfs_root)
+		return -ENODEV;
+	if (!debugfs_create_file("pgtable_cache", S_IRUGO,
+			riscv_debugfs_root, NULL, &pgt_cache_fops))
+		return -ENOMEM;
+	return 0;
+}
+device_initcall(pgt_cache_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
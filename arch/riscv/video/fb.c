@@ -48,7 +48,7 @@ static struct fb_ops iris_ops = {
 
 struct iris_par {
     u32 pseudo_palette[16];
-    u32 *reg;
+    u32 __iomem *reg;
 };
 
 static int iris_setcolreg(u_int regno, u_int red, u_int green, u_int blue, u_int transp, struct fb_info *info) {
@@ -257,7 +257,7 @@ static int iris_probe(struct platform_device *dev) {
 
     // Setup mem location    
     info->fbops = &iris_ops;
-    info->screen_base = mem;
+    info->screen_buffer = mem;
 
     struct iris_par *par = info->par;
     platform_set_drvdata(dev, info);